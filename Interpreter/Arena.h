@@ -0,0 +1,56 @@
+﻿#pragma once
+#include <new>
+#include <memory>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+using std::vector;
+using std::unique_ptr;
+
+struct Arena {
+  static const size_t BlockSize = 64 * 1024;
+
+  struct Destructor {
+    void* object;
+    void (*destroy)(void*);
+  };
+
+  vector<unique_ptr<char[]>> blocks;
+  vector<Destructor> destructors;
+  char* position = nullptr;
+  char* end = nullptr;
+
+  Arena() = default;
+  Arena(const Arena&) = delete;
+  auto operator=(const Arena&)->Arena& = delete;
+
+  ~Arena() {
+    for (auto i = destructors.rbegin(); i != destructors.rend(); i++)
+      i->destroy(i->object);
+  }
+
+  auto allocate(size_t size, size_t alignment)->void* {
+    auto address = reinterpret_cast<uintptr_t>(position);
+    auto aligned = (address + alignment - 1) & ~(alignment - 1);
+    if (position == nullptr || aligned + size > reinterpret_cast<uintptr_t>(end)) {
+      auto blockSize = size + alignment > BlockSize ? size + alignment : BlockSize;
+      blocks.emplace_back(new char[blockSize]);
+      position = blocks.back().get();
+      end = position + blockSize;
+      address = reinterpret_cast<uintptr_t>(position);
+      aligned = (address + alignment - 1) & ~(alignment - 1);
+    }
+    position = reinterpret_cast<char*>(aligned + size);
+    return reinterpret_cast<void*>(aligned);
+  }
+
+  template<typename T>
+  auto make()->T* {
+    auto result = new (allocate(sizeof(T), alignof(T))) T();
+    if (std::is_trivially_destructible<T>::value == false)
+      destructors.push_back({result, [](void* object) { static_cast<T*>(object)->~T(); }});
+    return result;
+  }
+};
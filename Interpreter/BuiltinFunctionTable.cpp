@@ -37,8 +37,8 @@ map<string, function<any(vector<any>)>> builtinFunctionTable = {
   }},
   {"erase", [](vector<any> values)->any {
     if (values.size() == 2 && isMap(values[0]) && isString(values[1]) &&
-        toMap(values[0])->values.count(toString(values[1]))) {
-      auto result = toMap(values[0])->values.at(toString(values[1]));
+        toMap(values[0])->values.find(toString(values[1])) != nullptr) {
+      auto result = *toMap(values[0])->values.find(toString(values[1]));
       toMap(values[0])->values.erase(toString(values[1]));
       return result;
     }
@@ -0,0 +1,508 @@
+﻿#include <map>
+#include <any>
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include "Datatype.h"
+#include "Node.h"
+#include <cmath>
+
+using std::any;
+using std::map;
+using std::less;
+using std::move;
+using std::fill;
+using std::pair;
+using std::plus;
+using std::cout;
+using std::endl;
+using std::vector;
+using std::greater;
+using std::minus;
+using std::any_cast;
+using std::function;
+using std::equal_to;
+using std::multiplies;
+using std::less_equal;
+using std::greater_equal;
+
+extern any returnValue;
+extern map<string, any> global;
+extern vector<any> local;
+extern size_t frame;
+extern map<string, Function*> functionTable;
+extern map<string, function<any(vector<any>)>> builtinFunctionTable;
+
+static auto compileBlock(vector<Statement*>&)->function<Status()>;
+static auto enterScope(Scope)->void;
+static auto findGlobal(const string&)->any;
+template<typename Operator>
+static auto compileComparison(Expression*, Expression*)->function<any()>;
+template<typename Operator>
+static auto compileArithmetic(Expression*, Expression*)->function<any()>;
+
+// 구문 트리를 실행 전에 한 번 클로저의 트리로 바꾼 뒤 실행한다. 연산자의 종류와
+// 피연산자의 모양은 바꿀 때 정해지므로 실행할 때는 다시 확인하지 않는다. 결과는
+// interpret()로 실행했을 때와 같다.
+auto execute(Program* program)->void {
+  functionTable.clear();
+  global.clear();
+  local.clear();
+  for (auto& node: program->functions) {
+    functionTable[node->name] = node;
+    node->body = node->compile();
+  }
+  if (functionTable["main"] == nullptr)
+    return;
+  local.resize(functionTable["main"]->frameSize);
+  frame = 0;
+  functionTable["main"]->body();
+  returnValue.reset();
+  local.clear();
+}
+
+auto Function::compile()->function<Status()> {
+  return compileBlock(block);
+}
+
+auto Return::compile()->function<Status()> {
+  return [value = expression->compile()] {
+    returnValue = value();
+    return Status::Return;
+  };
+}
+
+auto Variable::compile()->function<Status()> {
+  return [slot = slot, value = expression->compile()] {
+    auto result = value();
+    local[frame + slot] = result;
+    return Status::Normal;
+  };
+}
+
+auto For::compile()->function<Status()> {
+  auto initialize = variable->compile();
+  auto test = condition->compile();
+  auto increment = expression->compile();
+  auto body = compileBlock(block);
+  return [scope = scope, initialize, test, increment, body] {
+    enterScope(scope);
+    initialize();
+    while (isTrue(test())) {
+      auto status = body();
+      if (status == Status::Break)
+        break;
+      if (status == Status::Return)
+        return status;
+      increment();
+    }
+    return Status::Normal;
+  };
+}
+
+auto Break::compile()->function<Status()> {
+  if (isInLoop == false)
+    return [] { return Status::Normal; };
+  return [] { return Status::Break; };
+}
+
+auto Continue::compile()->function<Status()> {
+  if (isInLoop == false)
+    return [] { return Status::Normal; };
+  return [] { return Status::Continue; };
+}
+
+auto If::compile()->function<Status()> {
+  vector<function<any()>> tests;
+  vector<function<Status()>> bodies;
+  for (size_t i = 0; i < conditions.size(); i++) {
+    tests.push_back(conditions[i]->compile());
+    bodies.push_back(compileBlock(blocks[i]));
+  }
+  auto elseBody = compileBlock(elseBlock);
+  return [tests, bodies, scopes = scopes, elseBody, elseScope = elseScope] {
+    for (size_t i = 0; i < tests.size(); i++) {
+      if (isTrue(tests[i]()) == false)
+        continue;
+      enterScope(scopes[i]);
+      return bodies[i]();
+    }
+    enterScope(elseScope);
+    return elseBody();
+  };
+}
+
+auto Print::compile()->function<Status()> {
+  vector<function<any()>> values;
+  for (auto& node: arguments)
+    values.push_back(node->compile());
+  return [values, lineFeed = lineFeed] {
+    for (auto& value: values) {
+      auto result = value();
+      cout << result;
+    }
+    if (lineFeed) cout << endl;
+    return Status::Normal;
+  };
+}
+
+auto ExpressionStatement::compile()->function<Status()> {
+  return [value = expression->compile()] {
+    value();
+    return Status::Normal;
+  };
+}
+
+auto Or::compile()->function<any()> {
+  return [lValue = lhs->compile(), rValue = rhs->compile()]()->any {
+    return isTrue(lValue()) ? true : rValue();
+  };
+}
+
+auto And::compile()->function<any()> {
+  return [lValue = lhs->compile(), rValue = rhs->compile()]()->any {
+    return isFalse(lValue()) ? false : rValue();
+  };
+}
+
+// 오른쪽이 null이면 종류와 상관없이 참이 되는 interpret()의 규칙도 그대로 따른다.
+auto Relational::compile()->function<any()> {
+  switch (kind) {
+  case Kind::Equal:
+    if (dynamic_cast<NumberLiteral*>(rhs))
+      return compileComparison<equal_to<double>>(lhs, rhs);
+    return [lValue = lhs->compile(), rValue = rhs->compile()]()->any {
+      auto l = lValue();
+      auto r = rValue();
+      if (isNull(l) && isNull(r))
+        return true;
+      if (isBoolean(l) && isBoolean(r))
+        return toBoolean(l) == toBoolean(r);
+      if (isNumber(l) && isNumber(r))
+        return toNumber(l) == toNumber(r);
+      if (isString(l) && isString(r))
+        return toString(l) == toString(r);
+      return isNull(r);
+    };
+  case Kind::NotEqual:
+    return [lValue = lhs->compile(), rValue = rhs->compile()]()->any {
+      auto l = lValue();
+      auto r = rValue();
+      if (isNull(l) && isNull(r))
+        return false;
+      if (isNull(l) || isNull(r))
+        return true;
+      if (isBoolean(l) && isBoolean(r))
+        return toBoolean(l) != toBoolean(r);
+      if (isNumber(l) && isNumber(r))
+        return toNumber(l) != toNumber(r);
+      if (isString(l) && isString(r))
+        return toString(l) != toString(r);
+      return false;
+    };
+  case Kind::LessThan:       return compileComparison<less<double>>(lhs, rhs);
+  case Kind::GreaterThan:    return compileComparison<greater<double>>(lhs, rhs);
+  case Kind::LessOrEqual:    return compileComparison<less_equal<double>>(lhs, rhs);
+  case Kind::GreaterOrEqual: return compileComparison<greater_equal<double>>(lhs, rhs);
+  default:
+    return [lValue = lhs->compile(), rValue = rhs->compile()]()->any {
+      lValue();
+      return isNull(rValue());
+    };
+  }
+}
+
+auto Arithmetic::compile()->function<any()> {
+  switch (kind) {
+  case Kind::Add:
+    if (dynamic_cast<NumberLiteral*>(rhs))
+      return compileArithmetic<plus<double>>(lhs, rhs);
+    return [lValue = lhs->compile(), rValue = rhs->compile()]()->any {
+      auto l = lValue();
+      auto r = rValue();
+      auto x = any_cast<double>(&l);
+      auto y = any_cast<double>(&r);
+      if (x != nullptr && y != nullptr)
+        return *x + *y;
+      if (isString(l) && isString(r))
+        return toString(l) + toString(r);
+      return 0.0;
+    };
+  case Kind::Subtract: return compileArithmetic<minus<double>>(lhs, rhs);
+  case Kind::Multiply: return compileArithmetic<multiplies<double>>(lhs, rhs);
+  case Kind::Divide:
+    return [lValue = lhs->compile(), rValue = rhs->compile()]()->any {
+      auto l = lValue();
+      auto r = rValue();
+      if (isNumber(l) && isNumber(r))
+        return toNumber(r) == 0 ? 0.0 : toNumber(l) / toNumber(r);
+      return 0.0;
+    };
+  case Kind::Modulo:
+    return [lValue = lhs->compile(), rValue = rhs->compile()]()->any {
+      auto l = lValue();
+      auto r = rValue();
+      if (isNumber(l) && isNumber(r))
+        return toNumber(r) == 0 ? toNumber(l) : fmod(toNumber(l), toNumber(r));
+      return 0.0;
+    };
+  default:
+    return [lValue = lhs->compile(), rValue = rhs->compile()]()->any {
+      lValue();
+      rValue();
+      return 0.0;
+    };
+  }
+}
+
+auto Unary::compile()->function<any()> {
+  return [kind = kind, value = sub->compile()]()->any {
+    auto result = value();
+    if (kind == Kind::Add && isNumber(result))
+      return abs(toNumber(result));
+    if (kind == Kind::Subtract && isNumber(result))
+      return toNumber(result) * -1;
+    return 0.0;
+  };
+}
+
+auto Call::compile()->function<any()> {
+  vector<function<any()>> values;
+  for (auto& node: arguments)
+    values.push_back(node->compile());
+  return [callee = sub->compile(), values]()->any {
+    auto value = callee();
+    auto count = getHoldCount();
+    if (isBuiltinFunction(value)) {
+      vector<any> results;
+      for (auto& node: values) {
+        results.push_back(node());
+        hold(results.back());
+      }
+      auto result = toBuiltinFunction(value)(results);
+      release(count);
+      return result;
+    }
+    if (isFunction(value) == false)
+      return nullptr;
+    auto function = toFunction(value);
+    vector<any> results;
+    for (auto& node: values) {
+      results.push_back(node());
+      hold(results.back());
+    }
+    release(count);
+    auto caller = frame;
+    frame = local.size();
+    local.resize(frame + function->frameSize);
+    for (size_t i = 0; i < results.size() && i < function->parameters.size(); i++)
+      local[frame + function->parameterSlots[i]] = move(results[i]);
+    auto status = function->body();
+    local.resize(frame);
+    frame = caller;
+    if (status != Status::Return)
+      return nullptr;
+    any result;
+    result.swap(returnValue);
+    return result;
+  };
+}
+
+auto GetElement::compile()->function<any()> {
+  if (key != nullptr) {
+    return [object = sub->compile(), key = key]()->any {
+      auto result = object();
+      return isMap(result) ? getValueOfMap(result, key) : nullptr;
+    };
+  }
+  return [object = sub->compile(), key = index->compile()]()->any {
+    auto result = object();
+    auto count = getHoldCount();
+    hold(result);
+    auto index = key();
+    release(count);
+    if (isArray(result) && isNumber(index))
+      return getValueOfArray(result, index);
+    if (isMap(result) && isString(index))
+      return getValueOfMap(result, index);
+    return nullptr;
+  };
+}
+
+auto SetElement::compile()->function<any()> {
+  if (key != nullptr) {
+    return [object = sub->compile(), key = key, element = value->compile()]()->any {
+      auto result = object();
+      auto count = getHoldCount();
+      hold(result);
+      auto value = element();
+      release(count);
+      return isMap(result) ? setValueOfMap(result, key, value) : nullptr;
+    };
+  }
+  return [object = sub->compile(), key = index->compile(), element = value->compile()]()->any {
+    auto result = object();
+    auto count = getHoldCount();
+    hold(result);
+    auto index = key();
+    auto value = element();
+    release(count);
+    if (isArray(result) && isNumber(index))
+      return setValueOfArray(result, index, value);
+    if (isMap(result) && isString(index))
+      return setValueOfMap(result, index, value);
+    return nullptr;
+  };
+}
+
+// 후보 칸이 하나뿐인 참조가 대부분이므로 따로 만든다.
+auto GetVariable::compile()->function<any()> {
+  if (slots.empty())
+    return [name = name] { return findGlobal(name); };
+  if (slots.size() == 1) {
+    return [name = name, slot = slots[0]] {
+      auto& variable = local[frame + slot];
+      return variable.has_value() ? variable : findGlobal(name);
+    };
+  }
+  return [name = name, slots = slots] {
+    for (auto slot: slots) {
+      auto& variable = local[frame + slot];
+      if (variable.has_value())
+        return variable;
+    }
+    return findGlobal(name);
+  };
+}
+
+auto SetVariable::compile()->function<any()> {
+  return [name = name, slots = slots, value = value->compile()]()->any {
+    auto result = value();
+    for (auto slot: slots) {
+      auto& variable = local[frame + slot];
+      if (variable.has_value())
+        return variable = result;
+    }
+    return global[name] = result;
+  };
+}
+
+auto NullLiteral::compile()->function<any()> {
+  return []()->any { return nullptr; };
+}
+
+auto BooleanLiteral::compile()->function<any()> {
+  return [value = value]()->any { return value; };
+}
+
+auto NumberLiteral::compile()->function<any()> {
+  return [value = value]()->any { return value; };
+}
+
+auto StringLiteral::compile()->function<any()> {
+  return [value = value]()->any { return value; };
+}
+
+auto ArrayLiteral::compile()->function<any()> {
+  vector<function<any()>> elements;
+  for (auto& node: values)
+    elements.push_back(node->compile());
+  return [elements]()->any {
+    auto result = newArray();
+    auto count = getHoldCount();
+    hold(result);
+    for (auto& node: elements)
+      result->values.push_back(node());
+    release(count);
+    return result;
+  };
+}
+
+auto MapLiteral::compile()->function<any()> {
+  vector<pair<string, function<any()>>> elements;
+  for (auto& [key, value]: values)
+    elements.emplace_back(key, value->compile());
+  return [elements]()->any {
+    auto result = newMap();
+    auto count = getHoldCount();
+    hold(result);
+    for (auto& [key, value]: elements)
+      result->values[key] = value();
+    release(count);
+    return result;
+  };
+}
+
+auto compileBlock(vector<Statement*>& block)->function<Status()> {
+  vector<function<Status()>> statements;
+  for (auto& node: block)
+    statements.push_back(node->compile());
+  if (statements.empty())
+    return [] { return Status::Normal; };
+  if (statements.size() == 1)
+    return statements[0];
+  return [statements] {
+    for (auto& statement: statements) {
+      auto status = statement();
+      if (status != Status::Normal)
+        return status;
+    }
+    return Status::Normal;
+  };
+}
+
+auto enterScope(Scope scope)->void {
+  auto begin = local.begin() + frame + scope.offset;
+  fill(begin, begin + scope.size, any());
+}
+
+auto findGlobal(const string& name)->any {
+  if (auto iterator = global.find(name); iterator != global.end())
+    return iterator->second;
+  if (auto iterator = functionTable.find(name); iterator != functionTable.end())
+    return iterator->second;
+  if (auto iterator = builtinFunctionTable.find(name); iterator != builtinFunctionTable.end())
+    return iterator->second;
+  return nullptr;
+}
+
+// 비교할 두 값이 모두 숫자일 때를 먼저 처리한다. 오른쪽이 숫자 리터럴이면 그 값을 바로 쓴다.
+template<typename Operator>
+auto compileComparison(Expression* lhs, Expression* rhs)->function<any()> {
+  auto lValue = lhs->compile();
+  if (auto literal = dynamic_cast<NumberLiteral*>(rhs)) {
+    return [lValue, constant = literal->value]()->any {
+      auto l = lValue();
+      auto x = any_cast<double>(&l);
+      return x != nullptr && Operator()(*x, constant);
+    };
+  }
+  return [lValue, rValue = rhs->compile()]()->any {
+    auto l = lValue();
+    auto r = rValue();
+    auto x = any_cast<double>(&l);
+    auto y = any_cast<double>(&r);
+    if (x != nullptr && y != nullptr)
+      return Operator()(*x, *y);
+    return isNull(r);
+  };
+}
+
+template<typename Operator>
+auto compileArithmetic(Expression* lhs, Expression* rhs)->function<any()> {
+  auto lValue = lhs->compile();
+  if (auto literal = dynamic_cast<NumberLiteral*>(rhs)) {
+    return [lValue, constant = literal->value]()->any {
+      auto l = lValue();
+      auto x = any_cast<double>(&l);
+      return x != nullptr ? Operator()(*x, constant) : 0.0;
+    };
+  }
+  return [lValue, rValue = rhs->compile()]()->any {
+    auto l = lValue();
+    auto r = rValue();
+    auto x = any_cast<double>(&l);
+    auto y = any_cast<double>(&r);
+    return x != nullptr && y != nullptr ? Operator()(*x, *y) : 0.0;
+  };
+}
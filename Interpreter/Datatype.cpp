@@ -1,7 +1,10 @@
 #include <iomanip>
 #include <iostream>
+#include <algorithm>
 #include "Datatype.h"
 
+using std::sort;
+using std::pair;
 using std::ostream;
 using std::any_cast;
 using std::boolalpha;
@@ -81,8 +84,16 @@ auto toMap(any value)->Map* {
 }
 
 auto getValueOfMap(any object, any key)->any {
-  if (toMap(object)->values.count(toString(key)))
-    return toMap(object)->values[toString(key)];
+  auto value = toMap(object)->values.find(toString(key));
+  if (value != nullptr)
+    return *value;
+  return nullptr;
+}
+
+auto getValueOfMap(any object, Key* key)->any {
+  auto value = toMap(object)->values.find(key);
+  if (value != nullptr)
+    return *value;
   return nullptr;
 }
 
@@ -91,6 +102,11 @@ auto setValueOfMap(any object, any key, any value)->any {
   return value;
 }
 
+auto setValueOfMap(any object, Key* key, any value)->any {
+  toMap(object)->values[key] = value;
+  return value;
+}
+
 auto isFunction(any value)->bool {
   return value.type() == typeid(Function*);
 }
@@ -127,9 +143,16 @@ auto operator<<(ostream& stream, any& value)->ostream& {
     stream << "]";
   }
   else if (isMap(value)) {
+    vector<pair<const string*, any*>> entries;
+    toMap(value)->values.forEach([&](const string& key, any& value) {
+      entries.push_back({&key, &value});
+    });
+    sort(entries.begin(), entries.end(), [](auto& lhs, auto& rhs) {
+      return *lhs.first < *rhs.first;
+    });
     stream << "{ ";
-    for (auto& [key, value] : toMap(value)->values)
-      stream << key << ":" << value << " ";
+    for (auto& [key, value] : entries)
+      stream << *key << ":" << *value << " ";
     stream << "}";
   }
   return stream;
@@ -6,6 +6,7 @@
 #include <iostream>
 #include <functional>
 #include "Node.h"
+#include "HashMap.h"
 
 using std::any;
 using std::map;
@@ -24,7 +25,15 @@ struct Array: Object {
 };
 
 struct Map: Object {
-  map<string, any> values;
+  HashMap<any> values;
+};
+
+// heapSize는 첫 가비지 컬렉션을 시작할 객체의 수다. 컬렉션 뒤에는 살아남은 객체 수의
+// growthFactor배가 다음 기준이 된다.
+struct GarbageCollectorOptions {
+  size_t heapSize = 1 << 16;
+  double growthFactor = 2.0;
+  bool printStatistics = false;
 };
 
 auto isSize(any value)->bool;
@@ -51,7 +60,9 @@ auto setValueOfArray(any object, any index, any value)->any;
 auto isMap(any value)->bool;
 auto toMap(any value)->Map*;
 auto getValueOfMap(any object, any key)->any;
+auto getValueOfMap(any object, Key* key)->any;
 auto setValueOfMap(any object, any key, any value)->any;
+auto setValueOfMap(any object, Key* key, any value)->any;
 
 auto isFunction(any)->bool;
 auto toFunction(any)->Function*;
@@ -59,4 +70,12 @@ auto toFunction(any)->Function*;
 auto isBuiltinFunction(any value)->bool;
 auto toBuiltinFunction(any value)->function<any(vector<any>)>;
 
+auto newArray()->Array*;
+auto newMap()->Map*;
+auto hold(any value)->void;
+auto getHoldCount()->size_t;
+auto release(size_t count)->void;
+auto initializeHeap(GarbageCollectorOptions)->void;
+auto releaseHeap()->void;
+
 auto operator<<(ostream& stream, any& value)->ostream&;
@@ -0,0 +1,129 @@
+﻿#include <map>
+#include <chrono>
+#include <vector>
+#include <iostream>
+#include <algorithm>
+#include "Datatype.h"
+
+using std::max;
+using std::endl;
+using std::chrono::duration;
+using std::chrono::steady_clock;
+
+extern any returnValue;
+extern map<string, any> global;
+extern vector<any> local;
+
+static GarbageCollectorOptions options;
+static vector<Object*> objects;
+static vector<any> temporaries;
+static size_t threshold = 0;
+static size_t collectionCount = 0;
+static double totalPause = 0;
+static double maxPause = 0;
+
+static auto newObject(Object*)->void;
+static auto collectGarbage()->void;
+static auto markValue(any&)->void;
+
+// 식을 계산하는 동안 C++ 지역 변수에만 들고 있는 객체는 hold()로 잠시 루트에 올린다.
+// 할당할 때만 컬렉션이 일어나므로 그 사이에 다른 식이 계산되는 값만 올리면 된다.
+auto newArray()->Array* {
+  auto result = new Array();
+  newObject(result);
+  return result;
+}
+
+auto newMap()->Map* {
+  auto result = new Map();
+  newObject(result);
+  return result;
+}
+
+auto hold(any value)->void {
+  if (isArray(value) || isMap(value))
+    temporaries.push_back(value);
+}
+
+auto getHoldCount()->size_t {
+  return temporaries.size();
+}
+
+auto release(size_t count)->void {
+  temporaries.resize(count);
+}
+
+auto initializeHeap(GarbageCollectorOptions gcOptions)->void {
+  releaseHeap();
+  options = gcOptions;
+  threshold = options.heapSize;
+  collectionCount = 0;
+  totalPause = 0;
+  maxPause = 0;
+}
+
+auto releaseHeap()->void {
+  if (options.printStatistics && collectionCount != 0) {
+    std::cerr << "가비지 컬렉션: " << collectionCount << "회, ";
+    std::cerr << "총 정지 " << totalPause << "ms, 최대 정지 " << maxPause << "ms" << endl;
+  }
+  for (auto& object: objects)
+    delete object;
+  objects.clear();
+  temporaries.clear();
+  collectionCount = 0;
+}
+
+// 새 객체는 아직 어디에도 닿지 않으므로 컬렉션은 객체를 목록에 넣기 전에 한다.
+auto newObject(Object* object)->void {
+  if (objects.size() >= threshold)
+    collectGarbage();
+  objects.push_back(object);
+}
+
+// 루트는 모든 호출의 프레임, 전역 변수, 반환 중인 값, hold()로 올린 객체다.
+auto collectGarbage()->void {
+  auto begin = steady_clock::now();
+  for (auto& value: local)
+    markValue(value);
+  for (auto& [name, value]: global)
+    markValue(value);
+  markValue(returnValue);
+  for (auto& value: temporaries)
+    markValue(value);
+  auto survivor = objects.begin();
+  for (auto& object: objects) {
+    if (object->isMarked == false) {
+      delete object;
+      continue;
+    }
+    object->isMarked = false;
+    *survivor++ = object;
+  }
+  objects.erase(survivor, objects.end());
+  threshold = max(options.heapSize, static_cast<size_t>(objects.size() * options.growthFactor));
+  auto pause = duration<double, std::milli>(steady_clock::now() - begin).count();
+  collectionCount++;
+  totalPause += pause;
+  maxPause = max(maxPause, pause);
+}
+
+auto markValue(any& value)->void {
+  Object* object = nullptr;
+  if (isArray(value))
+    object = toArray(value);
+  else if (isMap(value))
+    object = toMap(value);
+  if (object == nullptr || object->isMarked)
+    return;
+  object->isMarked = true;
+  if (isArray(value)) {
+    for (auto& element: toArray(value)->values)
+      markValue(element);
+  }
+  else {
+    toMap(value)->values.forEach([](const string&, any& element) {
+      markValue(element);
+    });
+  }
+}
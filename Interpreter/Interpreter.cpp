@@ -1,7 +1,7 @@
 #include <map>
 #include <any>
-#include <list>
 #include <vector>
+#include <algorithm>
 #include <functional>
 #include "Datatype.h"
 #include "Node.h"
@@ -9,21 +9,23 @@
 
 using std::any;
 using std::map;
-using std::list;
+using std::move;
+using std::fill;
 using std::cout;
 using std::endl;
 using std::vector;
 using std::function;
 
-struct ReturnException { any result; };
-struct BreakException {};
-struct ContinueException {};
-
-static map<string, any> global;
-static list<list<map<string, any>>> local;
-static map<string, Function*> functionTable;
+any returnValue;
+map<string, any> global;
+vector<any> local;
+size_t frame = 0;
+map<string, Function*> functionTable;
 extern map<string, function<any(vector<any>)>> builtinFunctionTable;
 
+static auto enterScope(Scope)->void;
+static auto interpretBlock(vector<Statement*>&)->Status;
+
 auto interpret(Program* program)->void {
   functionTable.clear();
   global.clear();
@@ -32,86 +34,79 @@ auto interpret(Program* program)->void {
     functionTable[node->name] = node;
   if (functionTable["main"] == nullptr)
     return;
-  local.emplace_back().emplace_front();
-  try {
-    functionTable["main"]->interpret();
-  }
-  catch (ReturnException) {}
-  catch (BreakException) {}
-  catch (ContinueException) {}
-  local.pop_back();
+  local.resize(functionTable["main"]->frameSize);
+  frame = 0;
+  functionTable["main"]->interpret();
+  returnValue.reset();
+  local.clear();
 }
 
-auto Function::interpret()->void {
-  for (auto& node: block)
-    node->interpret();
+auto Function::interpret()->Status {
+  return interpretBlock(block);
 }
 
-auto Return::interpret()->void {
-  throw ReturnException{expression->interpret()};
+auto Return::interpret()->Status {
+  returnValue = expression->interpret();
+  return Status::Return;
 }
 
-auto Variable::interpret()->void {
-  local.back().front()[name] = expression->interpret();
+auto Variable::interpret()->Status {
+  auto value = expression->interpret();
+  local[frame + slot] = value;
+  return Status::Normal;
 }
 
-auto For::interpret()->void {
-  local.back().emplace_front();
+auto For::interpret()->Status {
+  enterScope(scope);
   variable->interpret();
   while (true) {
     auto result = condition->interpret();
     if (isTrue(result) == false)
       break;
-    try {
-      for (auto& node: block)
-        node->interpret();
-    } catch (ContinueException) {
-      /* empty */
-    } catch (BreakException) {
+    auto status = interpretBlock(block);
+    if (status == Status::Break)
       break;
-    }
+    if (status == Status::Return)
+      return status;
     expression->interpret();
   }
-  local.back().pop_front();
+  return Status::Normal;
 }
 
-auto Break::interpret()->void {
-  throw BreakException();
+auto Break::interpret()->Status {
+  return isInLoop ? Status::Break : Status::Normal;
 }
 
-auto Continue::interpret()->void {
-  throw ContinueException();
+auto Continue::interpret()->Status {
+  return isInLoop ? Status::Continue : Status::Normal;
 }
 
-auto If::interpret()->void {
+auto If::interpret()->Status {
   for (size_t i = 0; i < conditions.size(); i++) {
     auto result = conditions[i]->interpret();
     if (isTrue(result) == false)
       continue;
-    local.back().emplace_front();
-    for (auto& node: blocks[i])
-      node->interpret();
-    local.back().pop_front();
-    return;
+    enterScope(scopes[i]);
+    return interpretBlock(blocks[i]);
   }
   if (elseBlock.empty())
-    return;
-  local.back().emplace_front();
-  for (auto& node: elseBlock)
-    node->interpret();
-  local.back().pop_front();
+    return Status::Normal;
+  enterScope(elseScope);
+  return interpretBlock(elseBlock);
 }
 
-auto Print::interpret()->void {
+auto Print::interpret()->Status {
   for (auto& node: arguments) {
     auto value = node->interpret();
     cout << value;
   }
   if (lineFeed) cout << endl;
+  return Status::Normal;
 }
 
-auto ExpressionStatement::interpret()->void {
+auto ExpressionStatement::interpret()->Status {
   expression->interpret();
+  return Status::Normal;
 }
 
 auto Or::interpret()->any {
@@ -202,33 +197,51 @@ auto Unary::interpret()->any {
 
 auto Call::interpret()->any {
   auto value = sub->interpret();
+  auto count = getHoldCount();
   if (isBuiltinFunction(value)) {
     vector<any> values;
-    for (size_t i = 0; i < arguments.size(); i++)
+    for (size_t i = 0; i < arguments.size(); i++) {
       values.push_back(arguments[i]->interpret());
-    return toBuiltinFunction(value)(values);
+      hold(values.back());
+    }
+    auto result = toBuiltinFunction(value)(values);
+    release(count);
+    return result;
   }
   if (isFunction(value) == false)
     return nullptr;
-  map<string, any> parameters;
+  auto function = toFunction(value);
+  vector<any> values;
   for (size_t i = 0; i < arguments.size(); i++) {
-    auto name = toFunction(value)->parameters[i];
-    parameters[name] = arguments[i]->interpret();
+    values.push_back(arguments[i]->interpret());
+    hold(values.back());
   }
-  local.emplace_back().push_front(parameters);
-  try {
-    toFunction(value)->interpret();
-  } catch (ReturnException exception) {
-    local.pop_back();
-    return exception.result;
-  }
-  local.pop_back();
-  return nullptr;
+  release(count);
+  auto caller = frame;
+  frame = local.size();
+  local.resize(frame + function->frameSize);
+  for (size_t i = 0; i < values.size() && i < function->parameters.size(); i++)
+    local[frame + function->parameterSlots[i]] = move(values[i]);
+  auto status = function->interpret();
+  local.resize(frame);
+  frame = caller;
+  if (status != Status::Return)
+    return nullptr;
+  any result;
+  result.swap(returnValue);
+  return result;
 }
 
 auto GetElement::interpret()->any {
+  if (key != nullptr) {
+    auto object = sub->interpret();
+    return isMap(object) ? getValueOfMap(object, key) : nullptr;
+  }
   auto object = sub->interpret();
+  auto count = getHoldCount();
+  hold(object);
   auto index_ = index->interpret();
+  release(count);
   if (isArray(object) && isNumber(index_))
     return getValueOfArray(object, index_);
   if (isMap(object) && isString(index_))
@@ -238,8 +251,16 @@ auto GetElement::interpret()->any {
 
 auto SetElement::interpret()->any {
   auto object = sub->interpret();
+  auto count = getHoldCount();
+  hold(object);
+  if (key != nullptr) {
+    auto value_ = value->interpret();
+    release(count);
+    return isMap(object) ? setValueOfMap(object, key, value_) : nullptr;
+  }
   auto index_ = index->interpret();
   auto value_ = value->interpret();
+  release(count);
   if (isArray(object) && isNumber(index_))
     return setValueOfArray(object, index_, value_);
   if (isMap(object) && isString(index_))
@@ -248,9 +269,10 @@ auto SetElement::interpret()->any {
 }
 
 auto GetVariable::interpret()->any {
-  for (auto& variables: local.back()) {
-    if (variables.count(name))
-      return variables[name];
+  for (auto slot: slots) {
+    auto& variable = local[frame + slot];
+    if (variable.has_value())
+      return variable;
   }
   if (global.count(name))
     return global[name];
@@ -262,11 +284,13 @@ auto GetVariable::interpret()->any {
 }
 
 auto SetVariable::interpret()->any {
-  for (auto& variables: local.back()) {
-    if (variables.count(name))
-      return variables[name] = value->interpret();
+  auto result = value->interpret();
+  for (auto slot: slots) {
+    auto& variable = local[frame + slot];
+    if (variable.has_value())
+      return variable = result;
   }
-  return global[name] = value->interpret();
+  return global[name] = result;
 }
 
 auto NullLiteral::interpret()->any {
@@ -286,15 +310,37 @@ auto StringLiteral::interpret()->any {
 }
 
 auto ArrayLiteral::interpret()->any {
-  auto result = new Array();
+  auto result = newArray();
+  auto count = getHoldCount();
+  hold(result);
   for (auto& node: values)
     result->values.push_back(node->interpret());
+  release(count);
   return result;
 }
 
 auto MapLiteral::interpret()->any {
-  auto result = new Map();
+  auto result = newMap();
+  auto count = getHoldCount();
+  hold(result);
   for (auto& [key, value]: values)
-    result->values.insert_or_assign(key, value->interpret());
+    result->values[key] = value->interpret();
+  release(count);
   return result;
 }
+
+// 블록에 들어갈 때 블록의 칸을 비워 이전에 실행한 블록의 값이 보이지 않게 한다.
+auto enterScope(Scope scope)->void {
+  auto begin = local.begin() + frame + scope.offset;
+  fill(begin, begin + scope.size, any());
+}
+
+// 블록의 문장을 차례로 실행하다가 흐름이 바뀌면 멈추고 그 상태를 돌려준다.
+auto interpretBlock(vector<Statement*>& block)->Status {
+  for (auto& node: block) {
+    auto status = node->interpret();
+    if (status != Status::Normal)
+      return status;
+  }
+  return Status::Normal;
+}
@@ -1,4 +1,48 @@
-﻿#include "Main.h"
+﻿#include <chrono>
+#include <fstream>
+#include "Main.h"
+#include "Datatype.h"
+#include "SourceFile.h"
+
+using std::cout;
+using std::endl;
+using std::ifstream;
+using std::to_string;
+using std::chrono::duration;
+using std::chrono::steady_clock;
+
+static auto benchmarkScan(size_t megabytes)->void {
+  string sourceCode;
+  for (size_t i = 0; sourceCode.size() < megabytes * 1024 * 1024; i++) {
+    auto name = "element" + to_string(i);
+    sourceCode += R""""(
+    function count)"""" + name + R""""((list, limit) {
+      var total = 0;
+      for i = 0, i < limit, i = i + 1 {
+        if list[i] >= 12.5 and list[i] != null {
+          total = total + list[i] * 3 % 7;
+        }
+        elif list[i] == 'Hello, World!' {
+          printLine 'the quick brown fox jumps over the lazy dog';
+        }
+      }
+      return { 'name': ')"""" + name + R""""(', 'total': total };
+    }
+)"""";
+  }
+  size_t tokens = 0;
+  duration<double> fastest(0);
+  for (auto i = 0; i < 10; i++) {
+    auto begin = steady_clock::now();
+    tokens = scan(sourceCode).size();
+    duration<double> seconds = steady_clock::now() - begin;
+    if (i == 0 || seconds < fastest)
+      fastest = seconds;
+  }
+  auto size = sourceCode.size() / (1024.0 * 1024.0);
+  cout << size << " MB, " << tokens << " tokens: ";
+  cout << size / fastest.count() << " MB/s" << endl;
+}
 
 auto main(int argc, char** argv)->int {  
   string sourceCode = R""""(
@@ -6,8 +50,50 @@ auto main(int argc, char** argv)->int {
       print 'Hello, World!';
     }
   )"""";
-  auto tokenList = scan(sourceCode);
-  auto syntaxTree = parse(tokenList);
-  interpret(syntaxTree);
+  auto isStreaming = false;
+  auto isCompiling = false;
+  GarbageCollectorOptions options;
+  string path;
+  for (auto i = 1; i < argc; i++) {
+    string argument = argv[i];
+    if (argument.rfind("--scan-benchmark=", 0) == 0) {
+      benchmarkScan(stoul(argument.substr(17)));
+      return 0;
+    }
+    else if (argument == "--stream")
+      isStreaming = true;
+    else if (argument == "--closure")
+      isCompiling = true;
+    else if (argument == "--gc-stats")
+      options.printStatistics = true;
+    else if (argument.rfind("--gc-heap=", 0) == 0)
+      options.heapSize = stoul(argument.substr(10));
+    else
+      path = argument;
+  }
+  unique_ptr<Program> syntaxTree;
+  if (path.empty()) {
+    syntaxTree = parse(scan(sourceCode));
+  }
+  else if (isStreaming) {
+    ifstream stream(path, ifstream::binary);
+    if (stream.is_open() == false) {
+      cout << path << " 파일을 열 수 없습니다.";
+      exit(1);
+    }
+    syntaxTree = parse(scanStream(stream));
+  }
+  else {
+    SourceFile sourceFile(path);
+    syntaxTree = parse(scan(sourceFile.view()));
+  }
+  optimize(syntaxTree.get());
+  resolve(syntaxTree.get());
+  initializeHeap(options);
+  if (isCompiling)
+    execute(syntaxTree.get());
+  else
+    interpret(syntaxTree.get());
+  releaseHeap();
   return 0;
 }
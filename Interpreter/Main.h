@@ -1,7 +1,16 @@
 #pragma once
+#include <functional>
 #include "Token.h"
 #include "Node.h"
 
-auto scan(string)->vector<Token>;
-auto parse(vector<Token>)->Program*;
+using std::istream;
+using std::function;
+
+auto scan(string_view)->vector<Token>;
+auto scanStream(istream&)->function<Token()>;
+auto parse(vector<Token>)->unique_ptr<Program>;
+auto parse(function<Token()>)->unique_ptr<Program>;
+auto optimize(Program*)->void;
+auto resolve(Program*)->void;
 auto interpret(Program*)->void;
+auto execute(Program*)->void;
@@ -3,41 +3,78 @@
 #include <map>
 #include <vector>
 #include <string>
+#include <functional>
 #include "Token.h"
+#include "Arena.h"
 
 using std::any;
 using std::map;
 using std::vector;
 using std::string;
+using std::function;
+
+struct Key;
+struct ResolverContext;
+
+// 문장을 실행한 뒤 흐름이 어떻게 이어지는지를 알린다. 반복문과 함수 호출이 이를 받아 처리한다.
+enum class Status {
+  Normal, Return, Break, Continue,
+};
+
+// 블록 하나가 차지하는 프레임 칸의 범위다. 블록에 들어갈 때 이 칸들을 비운다.
+struct Scope {
+  size_t offset = 0;
+  size_t size = 0;
+};
 
 struct Program {
   vector<struct Function*> functions;
+  Arena arena;
 };
 
 struct Statement {
-  virtual auto interpret()->void = 0;
+  virtual auto optimize(Arena&)->void = 0;
+  virtual auto resolve(ResolverContext&)->void = 0;
+  virtual auto interpret()->Status = 0;
+  virtual auto compile()->function<Status()> = 0;
 };
 
 struct Expression {
+  virtual auto optimize(Arena&)->Expression* = 0;
+  virtual auto resolve(ResolverContext&)->void = 0;
   virtual auto interpret()->any = 0;
+  virtual auto compile()->function<any()> = 0;
 };
 
 struct Function: Statement {
   string name;
   vector<string> parameters;
   vector<Statement*> block;
-  auto interpret()->void;
+  vector<size_t> parameterSlots;
+  size_t frameSize = 0;
+  function<Status()> body;
+  auto optimize(Arena&)->void;
+  auto resolve(ResolverContext&)->void;
+  auto interpret()->Status;
+  auto compile()->function<Status()>;
 };
 
 struct Variable: Statement {
   string name;
   Expression* expression;
-  auto interpret()->void;
+  size_t slot = 0;
+  auto optimize(Arena&)->void;
+  auto resolve(ResolverContext&)->void;
+  auto interpret()->Status;
+  auto compile()->function<Status()>;
 };
 
 struct Return: Statement {
   Expression* expression;
-  auto interpret()->void;
+  auto optimize(Arena&)->void;
+  auto resolve(ResolverContext&)->void;
+  auto interpret()->Status;
+  auto compile()->function<Status()>;
 };
 
 struct For: Statement {
@@ -45,122 +82,197 @@ struct For: Statement {
   Expression* condition;
   Expression* expression;
   vector<Statement*> block;
-  auto interpret()->void;
+  Scope scope;
+  auto optimize(Arena&)->void;
+  auto resolve(ResolverContext&)->void;
+  auto interpret()->Status;
+  auto compile()->function<Status()>;
 };
 
 struct Break: Statement {
-  auto interpret()->void;
+  bool isInLoop = false;
+  auto optimize(Arena&)->void;
+  auto resolve(ResolverContext&)->void;
+  auto interpret()->Status;
+  auto compile()->function<Status()>;
 };
 
 struct Continue: Statement {
-  auto interpret()->void;
+  bool isInLoop = false;
+  auto optimize(Arena&)->void;
+  auto resolve(ResolverContext&)->void;
+  auto interpret()->Status;
+  auto compile()->function<Status()>;
 };
 
 struct If: Statement {
   vector<Expression*> conditions;
   vector<vector<Statement*>> blocks;
   vector<Statement*> elseBlock;
-  auto interpret()->void;
+  vector<Scope> scopes;
+  Scope elseScope;
+  auto optimize(Arena&)->void;
+  auto resolve(ResolverContext&)->void;
+  auto interpret()->Status;
+  auto compile()->function<Status()>;
 };
 
 struct Print: Statement {
   bool lineFeed = false;
   vector<Expression*> arguments;
-  auto interpret()->void;
+  auto optimize(Arena&)->void;
+  auto resolve(ResolverContext&)->void;
+  auto interpret()->Status;
+  auto compile()->function<Status()>;
 };
 
 struct ExpressionStatement: Statement {
   Expression* expression;
-  auto interpret()->void;
+  auto optimize(Arena&)->void;
+  auto resolve(ResolverContext&)->void;
+  auto interpret()->Status;
+  auto compile()->function<Status()>;
 };
 
 struct Or: Expression {
   Expression* lhs;
   Expression* rhs;
+  auto optimize(Arena&)->Expression*;
+  auto resolve(ResolverContext&)->void;
   auto interpret()->any;
+  auto compile()->function<any()>;
 };
 
 struct And: Expression {
   Expression* lhs;
   Expression* rhs;
+  auto optimize(Arena&)->Expression*;
+  auto resolve(ResolverContext&)->void;
   auto interpret()->any;
+  auto compile()->function<any()>;
 };
 
 struct Relational: Expression {
   Kind kind;
   Expression* lhs;
   Expression* rhs;
+  auto optimize(Arena&)->Expression*;
+  auto resolve(ResolverContext&)->void;
   auto interpret()->any;
+  auto compile()->function<any()>;
 };
 
 struct Arithmetic: Expression {
   Kind kind;
   Expression* lhs;
   Expression* rhs;
+  auto optimize(Arena&)->Expression*;
+  auto resolve(ResolverContext&)->void;
   auto interpret()->any;
+  auto compile()->function<any()>;
 };
 
 struct Unary: Expression {
   Kind kind;
   Expression* sub;
+  auto optimize(Arena&)->Expression*;
+  auto resolve(ResolverContext&)->void;
   auto interpret()->any;
+  auto compile()->function<any()>;
 };
 
 struct Call: Expression {
   Expression* sub;
   vector<Expression*> arguments;
+  auto optimize(Arena&)->Expression*;
+  auto resolve(ResolverContext&)->void;
   auto interpret()->any;
+  auto compile()->function<any()>;
 };
 
 struct GetElement: Expression {
   Expression* sub;
   Expression* index;
+  Key* key = nullptr;
+  auto optimize(Arena&)->Expression*;
+  auto resolve(ResolverContext&)->void;
   auto interpret()->any;
+  auto compile()->function<any()>;
 };
 
 struct SetElement: Expression {
   Expression* sub;
   Expression* index;
   Expression* value;
+  Key* key = nullptr;
+  auto optimize(Arena&)->Expression*;
+  auto resolve(ResolverContext&)->void;
   auto interpret()->any;
+  auto compile()->function<any()>;
 };
 
 struct GetVariable: Expression {
   string name;
+  vector<size_t> slots;
+  auto optimize(Arena&)->Expression*;
+  auto resolve(ResolverContext&)->void;
   auto interpret()->any;
+  auto compile()->function<any()>;
 };
 
 struct SetVariable: Expression {
   string name;
   Expression* value;
+  vector<size_t> slots;
+  auto optimize(Arena&)->Expression*;
+  auto resolve(ResolverContext&)->void;
   auto interpret()->any;
+  auto compile()->function<any()>;
 };
 
 struct NullLiteral: Expression {
+  auto optimize(Arena&)->Expression*;
+  auto resolve(ResolverContext&)->void;
   auto interpret()->any;
+  auto compile()->function<any()>;
 };
 
 struct BooleanLiteral: Expression {
   bool value = false;
+  auto optimize(Arena&)->Expression*;
+  auto resolve(ResolverContext&)->void;
   auto interpret()->any;
+  auto compile()->function<any()>;
 };
 
 struct NumberLiteral: Expression {
   double value = 0.0;
+  auto optimize(Arena&)->Expression*;
+  auto resolve(ResolverContext&)->void;
   auto interpret()->any;
+  auto compile()->function<any()>;
 };
 
 struct StringLiteral: Expression {
   string value;
+  auto optimize(Arena&)->Expression*;
+  auto resolve(ResolverContext&)->void;
   auto interpret()->any;
+  auto compile()->function<any()>;
 };
 
 struct ArrayLiteral: Expression {
   vector<Expression*> values;
+  auto optimize(Arena&)->Expression*;
+  auto resolve(ResolverContext&)->void;
   auto interpret()->any;
+  auto compile()->function<any()>;
 };
 
 struct MapLiteral: Expression {
   map<string, Expression*> values;
+  auto optimize(Arena&)->Expression*;
+  auto resolve(ResolverContext&)->void;
   auto interpret()->any;
+  auto compile()->function<any()>;
 };
@@ -0,0 +1,213 @@
+﻿#include "Main.h"
+#include "Datatype.h"
+
+using std::move;
+
+static auto optimizeBlock(Arena&, vector<Statement*>&)->void;
+static auto isConstant(Expression*)->bool;
+static auto isTrueLiteral(Expression*)->bool;
+static auto isFalseLiteral(Expression*)->bool;
+static auto toLiteral(Arena&, any, Expression*)->Expression*;
+
+// 구문 트리를 실행 전에 한 번 훑으며 리터럴로만 이루어진 식을 미리 계산하고
+// 조건이 상수인 분기를 정리한다. 식의 값은 노드의 interpret()로 구하므로
+// 실행했을 때와 결과가 같다.
+auto optimize(Program* program)->void {
+  for (auto& node: program->functions)
+    node->optimize(program->arena);
+}
+
+auto Function::optimize(Arena& arena)->void {
+  optimizeBlock(arena, block);
+}
+
+auto Variable::optimize(Arena& arena)->void {
+  expression = expression->optimize(arena);
+}
+
+auto Return::optimize(Arena& arena)->void {
+  expression = expression->optimize(arena);
+}
+
+auto For::optimize(Arena& arena)->void {
+  variable->optimize(arena);
+  condition = condition->optimize(arena);
+  expression = expression->optimize(arena);
+  optimizeBlock(arena, block);
+}
+
+auto Break::optimize(Arena&)->void {
+}
+
+auto Continue::optimize(Arena&)->void {
+}
+
+// 참인 상수 조건을 만나면 그 블록이 else 블록이 되고 뒤의 분기는 버린다.
+// 참이 아닌 상수 조건은 절대 선택되지 않으므로 블록과 함께 지운다.
+auto If::optimize(Arena& arena)->void {
+  for (size_t i = 0; i < conditions.size(); i++) {
+    conditions[i] = conditions[i]->optimize(arena);
+    optimizeBlock(arena, blocks[i]);
+  }
+  optimizeBlock(arena, elseBlock);
+  for (size_t i = 0; i < conditions.size();) {
+    if (isConstant(conditions[i]) == false) {
+      i++;
+      continue;
+    }
+    if (isTrueLiteral(conditions[i])) {
+      elseBlock = move(blocks[i]);
+      conditions.resize(i);
+      blocks.resize(i);
+      break;
+    }
+    conditions.erase(conditions.begin() + i);
+    blocks.erase(blocks.begin() + i);
+  }
+}
+
+auto Print::optimize(Arena& arena)->void {
+  for (auto& node: arguments)
+    node = node->optimize(arena);
+}
+
+auto ExpressionStatement::optimize(Arena& arena)->void {
+  expression = expression->optimize(arena);
+}
+
+auto Or::optimize(Arena& arena)->Expression* {
+  lhs = lhs->optimize(arena);
+  rhs = rhs->optimize(arena);
+  if (isConstant(lhs) == false)
+    return this;
+  return isTrueLiteral(lhs) ? lhs : rhs;
+}
+
+auto And::optimize(Arena& arena)->Expression* {
+  lhs = lhs->optimize(arena);
+  rhs = rhs->optimize(arena);
+  if (isConstant(lhs) == false)
+    return this;
+  return isFalseLiteral(lhs) ? lhs : rhs;
+}
+
+auto Relational::optimize(Arena& arena)->Expression* {
+  lhs = lhs->optimize(arena);
+  rhs = rhs->optimize(arena);
+  if (isConstant(lhs) == false || isConstant(rhs) == false)
+    return this;
+  return toLiteral(arena, interpret(), this);
+}
+
+auto Arithmetic::optimize(Arena& arena)->Expression* {
+  lhs = lhs->optimize(arena);
+  rhs = rhs->optimize(arena);
+  if (isConstant(lhs) == false || isConstant(rhs) == false)
+    return this;
+  return toLiteral(arena, interpret(), this);
+}
+
+auto Unary::optimize(Arena& arena)->Expression* {
+  sub = sub->optimize(arena);
+  if (isConstant(sub) == false)
+    return this;
+  return toLiteral(arena, interpret(), this);
+}
+
+auto Call::optimize(Arena& arena)->Expression* {
+  sub = sub->optimize(arena);
+  for (auto& node: arguments)
+    node = node->optimize(arena);
+  return this;
+}
+
+auto GetElement::optimize(Arena& arena)->Expression* {
+  sub = sub->optimize(arena);
+  index = index->optimize(arena);
+  return this;
+}
+
+auto SetElement::optimize(Arena& arena)->Expression* {
+  sub = sub->optimize(arena);
+  index = index->optimize(arena);
+  value = value->optimize(arena);
+  return this;
+}
+
+auto GetVariable::optimize(Arena&)->Expression* {
+  return this;
+}
+
+auto SetVariable::optimize(Arena& arena)->Expression* {
+  value = value->optimize(arena);
+  return this;
+}
+
+auto NullLiteral::optimize(Arena&)->Expression* {
+  return this;
+}
+
+auto BooleanLiteral::optimize(Arena&)->Expression* {
+  return this;
+}
+
+auto NumberLiteral::optimize(Arena&)->Expression* {
+  return this;
+}
+
+auto StringLiteral::optimize(Arena&)->Expression* {
+  return this;
+}
+
+auto ArrayLiteral::optimize(Arena& arena)->Expression* {
+  for (auto& node: values)
+    node = node->optimize(arena);
+  return this;
+}
+
+auto MapLiteral::optimize(Arena& arena)->Expression* {
+  for (auto& [key, value]: values)
+    value = value->optimize(arena);
+  return this;
+}
+
+auto optimizeBlock(Arena& arena, vector<Statement*>& block)->void {
+  for (auto& node: block)
+    node->optimize(arena);
+}
+
+auto isConstant(Expression* node)->bool {
+  return dynamic_cast<NullLiteral*>(node) || dynamic_cast<BooleanLiteral*>(node) ||
+         dynamic_cast<NumberLiteral*>(node) || dynamic_cast<StringLiteral*>(node);
+}
+
+auto isTrueLiteral(Expression* node)->bool {
+  auto literal = dynamic_cast<BooleanLiteral*>(node);
+  return literal && literal->value;
+}
+
+auto isFalseLiteral(Expression* node)->bool {
+  auto literal = dynamic_cast<BooleanLiteral*>(node);
+  return literal && literal->value == false;
+}
+
+auto toLiteral(Arena& arena, any value, Expression* node)->Expression* {
+  if (isNull(value))
+    return arena.make<NullLiteral>();
+  if (isBoolean(value)) {
+    auto result = arena.make<BooleanLiteral>();
+    result->value = toBoolean(value);
+    return result;
+  }
+  if (isNumber(value)) {
+    auto result = arena.make<NumberLiteral>();
+    result->value = toNumber(value);
+    return result;
+  }
+  if (isString(value)) {
+    auto result = arena.make<StringLiteral>();
+    result->value = toString(value);
+    return result;
+  }
+  return node;
+}
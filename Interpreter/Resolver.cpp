@@ -0,0 +1,209 @@
+﻿#include <list>
+#include <algorithm>
+#include "Main.h"
+#include "HashMap.h"
+
+using std::max;
+using std::list;
+
+// 함수 하나를 훑는 동안의 블록 목록이다. 앞쪽이 안쪽 블록이며 각 블록은 그 블록에서
+// 선언되는 이름과 프레임 칸 번호를 가진다.
+struct ResolverContext {
+  list<map<string, size_t>> scopes;
+  size_t offset = 0;
+  size_t frameSize = 0;
+  size_t loopDepth = 0;
+};
+
+static auto enterScope(ResolverContext&, vector<string>, vector<Statement*>&)->Scope;
+static auto leaveScope(ResolverContext&, Scope)->void;
+static auto resolveBlock(ResolverContext&, vector<Statement*>&)->void;
+static auto findSlots(ResolverContext&, const string&)->vector<size_t>;
+
+// 실행 전에 함수마다 변수 참조를 프레임 칸 번호로 바꿔 둔다. 블록에서 선언되는 이름은
+// 선언문의 위치와 상관없이 블록에 들어갈 때 칸이 정해지고, 형제 블록끼리는 칸을 같이 쓴다.
+// 참조는 이름이 선언될 수 있는 바깥 블록들의 칸을 안쪽부터 모두 가지며 실행할 때 값이 있는
+// 첫 칸을 쓰고, 없으면 전역 변수를 찾는다. 따라서 이름으로 찾던 때와 결과가 같다.
+auto resolve(Program* program)->void {
+  for (auto& node: program->functions) {
+    ResolverContext context;
+    node->resolve(context);
+  }
+}
+
+auto Function::resolve(ResolverContext& context)->void {
+  auto scope = enterScope(context, parameters, block);
+  parameterSlots.clear();
+  for (auto& name: parameters)
+    parameterSlots.push_back(context.scopes.front()[name]);
+  resolveBlock(context, block);
+  leaveScope(context, scope);
+  frameSize = context.frameSize;
+}
+
+auto Variable::resolve(ResolverContext& context)->void {
+  expression->resolve(context);
+  slot = context.scopes.front()[name];
+}
+
+auto Return::resolve(ResolverContext& context)->void {
+  expression->resolve(context);
+}
+
+auto For::resolve(ResolverContext& context)->void {
+  context.loopDepth++;
+  scope = enterScope(context, {variable->name}, block);
+  variable->resolve(context);
+  condition->resolve(context);
+  expression->resolve(context);
+  resolveBlock(context, block);
+  leaveScope(context, scope);
+  context.loopDepth--;
+}
+
+// 반복문 밖의 break와 continue는 아무 일도 하지 않는다. 상태를 그대로 돌려주면
+// 함수 호출이 상태를 지우기 전에 함수의 나머지 문장을 건너뛰게 된다.
+auto Break::resolve(ResolverContext& context)->void {
+  isInLoop = context.loopDepth > 0;
+}
+
+auto Continue::resolve(ResolverContext& context)->void {
+  isInLoop = context.loopDepth > 0;
+}
+
+auto If::resolve(ResolverContext& context)->void {
+  scopes.clear();
+  for (size_t i = 0; i < conditions.size(); i++) {
+    conditions[i]->resolve(context);
+    scopes.push_back(enterScope(context, {}, blocks[i]));
+    resolveBlock(context, blocks[i]);
+    leaveScope(context, scopes.back());
+  }
+  elseScope = enterScope(context, {}, elseBlock);
+  resolveBlock(context, elseBlock);
+  leaveScope(context, elseScope);
+}
+
+auto Print::resolve(ResolverContext& context)->void {
+  for (auto& node: arguments)
+    node->resolve(context);
+}
+
+auto ExpressionStatement::resolve(ResolverContext& context)->void {
+  expression->resolve(context);
+}
+
+auto Or::resolve(ResolverContext& context)->void {
+  lhs->resolve(context);
+  rhs->resolve(context);
+}
+
+auto And::resolve(ResolverContext& context)->void {
+  lhs->resolve(context);
+  rhs->resolve(context);
+}
+
+auto Relational::resolve(ResolverContext& context)->void {
+  lhs->resolve(context);
+  rhs->resolve(context);
+}
+
+auto Arithmetic::resolve(ResolverContext& context)->void {
+  lhs->resolve(context);
+  rhs->resolve(context);
+}
+
+auto Unary::resolve(ResolverContext& context)->void {
+  sub->resolve(context);
+}
+
+auto Call::resolve(ResolverContext& context)->void {
+  sub->resolve(context);
+  for (auto& node: arguments)
+    node->resolve(context);
+}
+
+// 문자열 리터럴로 찾는 원소는 맵의 키를 미리 등록해 두어 실행할 때 문자열을 만들거나
+// 해시하지 않는다. 구문 트리는 프로그램이 끝날 때까지 남으므로 키를 놓지 않는다.
+auto GetElement::resolve(ResolverContext& context)->void {
+  sub->resolve(context);
+  index->resolve(context);
+  if (auto literal = dynamic_cast<StringLiteral*>(index))
+    key = internKey(literal->value);
+}
+
+auto SetElement::resolve(ResolverContext& context)->void {
+  sub->resolve(context);
+  index->resolve(context);
+  value->resolve(context);
+  if (auto literal = dynamic_cast<StringLiteral*>(index))
+    key = internKey(literal->value);
+}
+
+auto GetVariable::resolve(ResolverContext& context)->void {
+  slots = findSlots(context, name);
+}
+
+auto SetVariable::resolve(ResolverContext& context)->void {
+  value->resolve(context);
+  slots = findSlots(context, name);
+}
+
+auto NullLiteral::resolve(ResolverContext&)->void {
+}
+
+auto BooleanLiteral::resolve(ResolverContext&)->void {
+}
+
+auto NumberLiteral::resolve(ResolverContext&)->void {
+}
+
+auto StringLiteral::resolve(ResolverContext&)->void {
+}
+
+auto ArrayLiteral::resolve(ResolverContext& context)->void {
+  for (auto& node: values)
+    node->resolve(context);
+}
+
+auto MapLiteral::resolve(ResolverContext& context)->void {
+  for (auto& [key, value]: values)
+    value->resolve(context);
+}
+
+// 주어진 이름들과 블록에 바로 들어 있는 선언문의 이름에 칸을 하나씩 준다.
+auto enterScope(ResolverContext& context, vector<string> names, vector<Statement*>& block)->Scope {
+  for (auto& node: block) {
+    if (auto variable = dynamic_cast<Variable*>(node))
+      names.push_back(variable->name);
+  }
+  Scope scope;
+  scope.offset = context.offset;
+  auto& slots = context.scopes.emplace_front();
+  for (auto& name: names) {
+    if (slots.count(name) == 0)
+      slots[name] = context.offset++;
+  }
+  scope.size = context.offset - scope.offset;
+  context.frameSize = max(context.frameSize, context.offset);
+  return scope;
+}
+
+auto leaveScope(ResolverContext& context, Scope scope)->void {
+  context.scopes.pop_front();
+  context.offset = scope.offset;
+}
+
+auto resolveBlock(ResolverContext& context, vector<Statement*>& block)->void {
+  for (auto& node: block)
+    node->resolve(context);
+}
+
+auto findSlots(ResolverContext& context, const string& name)->vector<size_t> {
+  vector<size_t> result;
+  for (auto& slots: context.scopes) {
+    if (slots.count(name))
+      result.push_back(slots[name]);
+  }
+  return result;
+}
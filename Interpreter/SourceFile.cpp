@@ -0,0 +1,72 @@
+﻿#include <iostream>
+#include "SourceFile.h"
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+using std::cout;
+
+static auto fail(string)->void;
+
+#ifdef _WIN32
+SourceFile::SourceFile(string path) {
+  file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (file == INVALID_HANDLE_VALUE)
+    fail(path);
+  LARGE_INTEGER fileSize;
+  if (GetFileSizeEx(file, &fileSize) == false)
+    fail(path);
+  size = static_cast<size_t>(fileSize.QuadPart);
+  if (size == 0)
+    return;
+  mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  if (mapping == nullptr)
+    fail(path);
+  data = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+  if (data == nullptr)
+    fail(path);
+}
+
+SourceFile::~SourceFile() {
+  if (data != nullptr)
+    UnmapViewOfFile(data);
+  if (mapping != nullptr)
+    CloseHandle(mapping);
+  if (file != nullptr && file != INVALID_HANDLE_VALUE)
+    CloseHandle(file);
+}
+#else
+SourceFile::SourceFile(string path) {
+  descriptor = open(path.c_str(), O_RDONLY);
+  if (descriptor < 0)
+    fail(path);
+  struct stat status;
+  if (fstat(descriptor, &status) < 0)
+    fail(path);
+  size = static_cast<size_t>(status.st_size);
+  if (size == 0)
+    return;
+  auto address = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+  if (address == MAP_FAILED)
+    fail(path);
+  madvise(address, size, MADV_SEQUENTIAL);
+  data = static_cast<const char*>(address);
+}
+
+SourceFile::~SourceFile() {
+  if (data != nullptr)
+    munmap(const_cast<char*>(data), size);
+  if (descriptor >= 0)
+    close(descriptor);
+}
+#endif
+
+auto fail(string path)->void {
+  cout << path << " 파일을 열 수 없습니다.";
+  exit(1);
+}
@@ -0,0 +1,15 @@
+#!/bin/sh
+# 사용법: run.sh <실행 파일> [옵션...]
+# 이 폴더의 스크립트를 실행해 같은 이름의 .out 파일과 출력을 비교한다.
+binary=$1
+shift
+status=0
+for script in "$(dirname "$0")"/*.yu; do
+  if "$binary" "$@" "$script" | cmp -s - "${script%.yu}.out"; then
+    echo "ok   $script"
+  else
+    echo "FAIL $script"
+    status=1
+  fi
+done
+exit $status
@@ -1,12 +1,15 @@
 ﻿#include <map>
+#include <array>
 #include <iomanip>
 #include "Token.h"
 
 using std::map;
+using std::array;
+using std::less;
 using std::setw;
 using std::left;
 
-static map<string, Kind> stringToKind = {
+static const map<string, Kind, less<>> stringToKind = {
   {"#unknown",    Kind::Unknown},
   {"#EndOfToken", Kind::EndOfToken},
 
@@ -58,16 +61,70 @@ static map<string, Kind> stringToKind = {
   {"]",           Kind::RightBraket},
 };
 
-static auto kindToString = [] {
+static const auto kindToString = [] {
   map<Kind, string> result;
   for (auto& [key, value] : stringToKind)
     result[value] = key;
   return result;
 }();
 
-auto toKind(string string)->Kind {
-  if (stringToKind.count(string))
-    return stringToKind.at(string);
+struct Keyword {
+  string_view string;
+  Kind kind = Kind::Unknown;
+};
+
+static constexpr Keyword keywords[] = {
+  {"null",      Kind::NullLiteral},
+  {"true",      Kind::TrueLiteral},
+  {"false",     Kind::FalseLiteral},
+  {"function",  Kind::Function},
+  {"return",    Kind::Return},
+  {"var",       Kind::Variable},
+  {"for",       Kind::For},
+  {"break",     Kind::Break},
+  {"continue",  Kind::Continue},
+  {"if",        Kind::If},
+  {"elif",      Kind::Elif},
+  {"else",      Kind::Else},
+  {"print",     Kind::Print},
+  {"printLine", Kind::PrintLine},
+  {"and",       Kind::LogicalAnd},
+  {"or",        Kind::LogicalOr},
+};
+
+static const size_t KeywordTableSize = 32;
+
+static constexpr auto hashKeyword(string_view string)->size_t {
+  return (string.size() + string.front() * 11 + string.back()) % KeywordTableSize;
+}
+
+static constexpr auto keywordTable = [] {
+  array<Keyword, KeywordTableSize> result{};
+  for (auto& keyword : keywords)
+    result[hashKeyword(keyword.string)] = keyword;
+  return result;
+}();
+
+static constexpr auto isPerfectHash = [] {
+  for (auto& keyword : keywords)
+    if (keywordTable[hashKeyword(keyword.string)].kind != keyword.kind)
+      return false;
+  return true;
+}();
+
+static_assert(isPerfectHash, "키워드 해시 테이블에 충돌이 있습니다.");
+
+auto toKeyword(string_view string)->Kind {
+  auto& keyword = keywordTable[hashKeyword(string)];
+  if (keyword.string == string)
+    return keyword.kind;
+  return Kind::Unknown;
+}
+
+auto toKind(string_view string)->Kind {
+  auto iterator = stringToKind.find(string);
+  if (iterator != stringToKind.end())
+    return iterator->second;
   return Kind::Unknown;
 }
 
@@ -1,9 +1,11 @@
 ﻿#pragma once
 #include <string>
 #include <iostream>
+#include <string_view>
 
 using std::string;
 using std::ostream;
+using std::string_view;
 
 enum class Kind {
   Unknown, EndOfToken,
@@ -33,12 +35,16 @@ enum class Kind {
   LeftBraket, RightBraket,
 };
 
-auto toKind(string)->Kind;
+auto toKind(string_view)->Kind;
+auto toKeyword(string_view)->Kind;
 auto toString(Kind)->string;
 
 struct Token {
   Kind kind = Kind::Unknown;
-  string string;
+  string_view string;
+  size_t offset = 0;
+  size_t line = 0;
+  size_t column = 0;
 };
 
 auto operator<<(ostream&, Token&)->ostream&;
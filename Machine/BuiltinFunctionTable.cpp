@@ -1,4 +1,3 @@
-#include <any>
 #include <map>
 #include <string>
 #include <vector>
@@ -6,28 +5,28 @@
 #include "Datatype.h"
 #include <cmath>
 
-using std::any;
 using std::map;
 using std::string;
 using std::vector;
 using std::function;
 
-map<string, function<any(vector<any>)>> builtinFunctionTable = {
-  {"length", [](vector<any> values)->any {
+map<string, function<Value(vector<Value>)>> builtinFunctionTable = {
+  {"length", [](vector<Value> values)->Value {
     if (values.size() == 1 && isArray(values[0]))
       return static_cast<double>(toArray(values[0])->values.size());
     if (values.size() == 1 && isMap(values[0]))
-      return static_cast<double>(toMap(values[0])->values.size());
+      return static_cast<double>(getSizeOfMap(values[0]));
     return 0.0;
   }},
-  {"push", [](vector<any> values)->any {
+  {"push", [](vector<Value> values)->Value {
     if (values.size() == 2 && isArray(values[0])) {
+      writeBarrier(values[0], values[1]);
       toArray(values[0])->values.push_back(values[1]);
       return values[0];
     }
     return nullptr;
   }},
-  {"pop", [](vector<any> values)->any {
+  {"pop", [](vector<Value> values)->Value {
     if (values.size() == 1 && isArray(values[0]) && toArray(values[0])->values.size() != 0) {
       auto result = toArray(values[0])->values.back();
       toArray(values[0])->values.pop_back();
@@ -35,19 +34,19 @@ map<string, function<any(vector<any>)>> builtinFunctionTable = {
     }
     return nullptr;
   }},
-  {"erase", [](vector<any> values)->any {
+  {"erase", [](vector<Value> values)->Value {
     if (values.size() == 2 && isMap(values[0]) && isString(values[1]) &&
-        toMap(values[0])->values.count(toString(values[1]))) {
-      auto result = toMap(values[0])->values.at(toString(values[1]));
-      toMap(values[0])->values.erase(toString(values[1]));
+        hasKeyOfMap(values[0], values[1])) {
+      auto result = getValueOfMap(values[0], values[1]);
+      eraseKeyOfMap(values[0], values[1]);
       return result;
     }
     return nullptr;
   }},
-  {"clock", [](vector<any> values)->any {
+  {"clock", [](vector<Value> values)->Value {
     return static_cast<double>(clock());
   }},
-  {"sqrt", [](vector<any> values)->any {
+  {"sqrt", [](vector<Value> values)->Value {
     return sqrt(toNumber(values[0]));
   }},
 };
@@ -1,13 +1,16 @@
 ﻿#pragma once
-#include <any>
+#include <map>
+#include <vector>
 #include <string>
-#include <iostream>
+#include <cstdint>
+#include <cstring>
+#include "Datatype.h"
 
-using std::any;
+using std::map;
+using std::vector;
 using std::string;
-using std::ostream;
 
-enum class Instruction {
+enum class Instruction: uint8_t {
   Exit,
   Call, Alloca, Return,
   Jump, ConditionJump,
@@ -23,19 +26,149 @@ enum class Instruction {
 
   GetElement, SetElement,
   GetGlobal, SetGlobal,
+  GetGlobalSlot, SetGlobalSlot,
   GetLocal, SetLocal,
 
   PushNull, PushBoolean,
   PushNumber, PushString,
+  PushFunction,
   PushArray, PushMap,
   PopOperand,
+
+  SetLocalPop, IncLocal, AddNumber,
+  EqualJump, NotEqualJump,
+  LessThanJump, GreaterThanJump,
+  LessOrEqualJump, GreaterOrEqualJump,
+  LessThanLocalConstantJump, LessThanLocalLocalJump,
+  GetField, SetField,
 };
 
-auto toString(Instruction)->string;
+enum class RegisterInstruction: uint8_t {
+  Exit,
+  Call, Alloca, Return,
+  Jump, ConditionJump,
+  Print, PrintLine,
+
+  LogicalOr, LogicalAnd,
+  Add, Subtract,
+  Multiply, Divide, Modulo,
+  Equal, NotEqual,
+  LessThan, GreaterThan,
+  LessOrEqual, GreaterOrEqual,
+  Absolute, ReverseSign,
+
+  GetElement, SetElement,
+  GetGlobal, SetGlobal,
+  GetGlobalSlot, SetGlobalSlot,
+  Move,
 
-struct Code {
-  Instruction instruction;
-  any operand;
+  LoadNull, LoadBoolean,
+  LoadConstant,
+  NewArray, NewMap,
 };
 
-auto operator<<(ostream&, Code&)->ostream&;
+auto toString(Instruction)->string;
+auto optimizeCode(vector<uint8_t>&, vector<size_t>&)->void;
+
+inline auto getOperandSize(Instruction instruction)->size_t {
+  switch (instruction) {
+  case Instruction::Call:
+  case Instruction::Alloca:
+  case Instruction::Jump:
+  case Instruction::ConditionJump:
+  case Instruction::Print:
+  case Instruction::LogicalOr:
+  case Instruction::LogicalAnd:
+  case Instruction::GetGlobal:
+  case Instruction::SetGlobal:
+  case Instruction::GetGlobalSlot:
+  case Instruction::SetGlobalSlot:
+  case Instruction::GetLocal:
+  case Instruction::SetLocal:
+  case Instruction::PushBoolean:
+  case Instruction::PushNumber:
+  case Instruction::PushString:
+  case Instruction::PushFunction:
+  case Instruction::PushArray:
+  case Instruction::PushMap:
+  case Instruction::SetLocalPop:
+  case Instruction::AddNumber:
+  case Instruction::EqualJump:
+  case Instruction::NotEqualJump:
+  case Instruction::LessThanJump:
+  case Instruction::GreaterThanJump:
+  case Instruction::LessOrEqualJump:
+  case Instruction::GreaterOrEqualJump:
+    return sizeof(uint32_t);
+  case Instruction::IncLocal:
+  case Instruction::GetField:
+  case Instruction::SetField:
+    return sizeof(uint32_t) * 2;
+  case Instruction::LessThanLocalConstantJump:
+  case Instruction::LessThanLocalLocalJump:
+    return sizeof(uint32_t) * 3;
+  default:
+    return 0;
+  }
+}
+
+inline auto getOperandCount(RegisterInstruction instruction)->size_t {
+  switch (instruction) {
+  case RegisterInstruction::Call:
+    return 4;
+  case RegisterInstruction::Add:
+  case RegisterInstruction::Subtract:
+  case RegisterInstruction::Multiply:
+  case RegisterInstruction::Divide:
+  case RegisterInstruction::Modulo:
+  case RegisterInstruction::Equal:
+  case RegisterInstruction::NotEqual:
+  case RegisterInstruction::LessThan:
+  case RegisterInstruction::GreaterThan:
+  case RegisterInstruction::LessOrEqual:
+  case RegisterInstruction::GreaterOrEqual:
+  case RegisterInstruction::GetElement:
+  case RegisterInstruction::SetElement:
+  case RegisterInstruction::NewArray:
+  case RegisterInstruction::NewMap:
+    return 3;
+  case RegisterInstruction::ConditionJump:
+  case RegisterInstruction::Print:
+  case RegisterInstruction::LogicalOr:
+  case RegisterInstruction::LogicalAnd:
+  case RegisterInstruction::Absolute:
+  case RegisterInstruction::ReverseSign:
+  case RegisterInstruction::GetGlobal:
+  case RegisterInstruction::SetGlobal:
+  case RegisterInstruction::GetGlobalSlot:
+  case RegisterInstruction::SetGlobalSlot:
+  case RegisterInstruction::Move:
+  case RegisterInstruction::LoadBoolean:
+  case RegisterInstruction::LoadConstant:
+    return 2;
+  case RegisterInstruction::Alloca:
+  case RegisterInstruction::Return:
+  case RegisterInstruction::Jump:
+  case RegisterInstruction::LoadNull:
+    return 1;
+  default:
+    return 0;
+  }
+}
+
+inline auto readOperand(const uint8_t* code)->size_t {
+  uint32_t operand;
+  memcpy(&operand, code, sizeof(operand));
+  return operand;
+}
+
+inline auto writeOperand(uint8_t* code, size_t operand)->void {
+  auto value = static_cast<uint32_t>(operand);
+  memcpy(code, &value, sizeof(value));
+}
+
+struct ObjectCode {
+  vector<uint8_t> codeList;
+  vector<Value> constantList;
+  map<string, size_t> functionTable;
+};
@@ -1,118 +1,229 @@
+﻿#include <cmath>
 #include <iomanip>
 #include <iostream>
+#include <algorithm>
 #include "Datatype.h"
 
+using std::sort;
+using std::pair;
 using std::ostream;
-using std::any_cast;
 using std::boolalpha;
 
-auto isSize(any value)->bool {
-  return value.type() == typeid(size_t);
-}
-
-auto toSize(any value)->size_t {
-  return any_cast<size_t>(value);
-}
-
-auto isNull(any value)->bool {
-  return value.type() == typeid(nullptr_t);
-}
-
-auto isTrue(any value)->bool {
-  return isBoolean(value) && toBoolean(value);
-}
-
-auto isFalse(any value)->bool {
-  return isBoolean(value) && toBoolean(value) == false;
-}
+static auto toDictionary(Map*)->void;
+static auto setSlotOfMap(Map*, Key*, Value)->void;
 
-auto isBoolean(any value)->bool {
-  return value.type() == typeid(bool);
-}
-
-auto toBoolean(any value)->bool {
-  return any_cast<bool>(value);
-}
-
-auto isNumber(any value)->bool {
-  return value.type() == typeid(double);
-}
-
-auto toNumber(any value)->double {
-  return any_cast<double>(value);
-}
-
-auto isString(any value)->bool {
-  return value.type() == typeid(string);
-}
-
-auto toString(any value)->string {
-  return any_cast<string>(value);
-}
-
-auto isArray(any value)->bool {
-  return value.type() == typeid(Array*);
-}
-
-auto toArray(any value)->Array* {
-  return any_cast<Array*>(value);
-}
-
-auto getValueOfArray(any object, any index)->any {
+auto getValueOfArray(Value object, Value index)->Value {
   auto i = static_cast<size_t>(toNumber(index));
   if (i >= 0 && i < toArray(object)->values.size())
     return toArray(object)->values[i];
   return nullptr;
 }
 
-auto setValueOfArray(any object, any index, any value)->any {
+auto setValueOfArray(Value object, Value index, Value value)->Value {
   auto i = static_cast<size_t>(toNumber(index));
-  if (i >= 0 && i < toArray(object)->values.size())
+  if (i >= 0 && i < toArray(object)->values.size()) {
+    writeBarrier(object, value);
     toArray(object)->values[i] = value;
+  }
   return value;
 }
 
-auto isMap(any value)->bool {
-  return value.type() == typeid(Map*);
+auto getElement(Value sub, Value index)->Value {
+  if (isArray(sub) && isNumber(index))
+    return getValueOfArray(sub, index);
+  if (isMap(sub) && isString(index))
+    return getValueOfMap(sub, index);
+  return nullptr;
 }
 
-auto toMap(any value)->Map* {
-  return any_cast<Map*>(value);
+auto setElement(Value sub, Value index, Value value)->void {
+  if (isArray(sub) && isNumber(index))
+    setValueOfArray(sub, index, value);
+  else if (isMap(sub) && isString(index))
+    setValueOfMap(sub, index, value);
+}
+
+auto Shape::getTransition(Key* key)->Shape* {
+  auto transition = transitions.find(key);
+  if (transition != nullptr)
+    return transition->get();
+  if (transitions.size() >= MaxTransitions)
+    return nullptr;
+  auto& result = transitions[key];
+  result.reset(new Shape());
+  result->slots = slots;
+  result->slots[key] = slots.size();
+  return result.get();
+}
+
+// 키 표에 없는 문자열은 어느 맵의 키도 아니므로 맵을 찾아보지 않는다.
+auto getValueOfMap(Value object, Value key)->Value {
+  auto map = toMap(object);
+  auto name = findKeyOf(key);
+  if (name == nullptr)
+    return nullptr;
+  if (map->shape == nullptr) {
+    auto value = map->values.find(name);
+    return value != nullptr ? *value : nullptr;
+  }
+  auto slot = map->shape->slots.find(name);
+  return slot != nullptr ? map->fields[*slot] : nullptr;
 }
 
-auto getValueOfMap(any object, any key)->any {
-  if (toMap(object)->values.count(toString(key)))
-    return toMap(object)->values[toString(key)];
-  return nullptr;
+auto setValueOfMap(Value object, Value key, Value value)->Value {
+  writeBarrier(object, value);
+  setSlotOfMap(toMap(object), internKeyOf(key), value);
+  return value;
 }
 
-auto setValueOfMap(any object, any key, any value)->any {
-  toMap(object)->values[toString(key)] = value;
-  return value;
+auto hasKeyOfMap(Value object, Value key)->bool {
+  auto map = toMap(object);
+  auto name = findKeyOf(key);
+  if (name == nullptr)
+    return false;
+  if (map->shape == nullptr)
+    return map->values.find(name) != nullptr;
+  return map->shape->slots.find(name) != nullptr;
+}
+
+auto eraseKeyOfMap(Value object, Value key)->void {
+  auto map = toMap(object);
+  if (map->shape != nullptr)
+    toDictionary(map);
+  auto name = findKeyOf(key);
+  if (name != nullptr)
+    map->values.erase(name);
 }
 
-auto isFunction(any value)->bool {
-  return value.type() == typeid(Function*);
+auto getSizeOfMap(Value object)->size_t {
+  auto map = toMap(object);
+  if (map->shape == nullptr)
+    return map->values.size();
+  return map->shape->slots.size();
 }
 
-auto toFunction(any value)->Function* {
-  return any_cast<Function*>(value);
+auto equal(Value lValue, Value rValue)->Value {
+  if (isNull(lValue) && isNull(rValue))
+    return true;
+  if (isBoolean(lValue) && isBoolean(rValue))
+    return toBoolean(lValue) == toBoolean(rValue);
+  if (isNumber(lValue) && isNumber(rValue))
+    return toNumber(lValue) == toNumber(rValue);
+  if (isString(lValue) && isString(rValue))
+    return toString(lValue) == toString(rValue);
+  return false;
+}
+
+auto notEqual(Value lValue, Value rValue)->Value {
+  if (isNull(lValue) && isNull(rValue))
+    return false;
+  if (isNull(lValue) || isNull(rValue))
+    return true;
+  if (isBoolean(lValue) && isBoolean(rValue))
+    return toBoolean(lValue) != toBoolean(rValue);
+  if (isNumber(lValue) && isNumber(rValue))
+    return toNumber(lValue) != toNumber(rValue);
+  if (isString(lValue) && isString(rValue))
+    return toString(lValue) != toString(rValue);
+  return false;
+}
+
+auto lessThan(Value lValue, Value rValue)->Value {
+  if (isNumber(lValue) && isNumber(rValue))
+    return toNumber(lValue) < toNumber(rValue);
+  return false;
+}
+
+auto greaterThan(Value lValue, Value rValue)->Value {
+  if (isNumber(lValue) && isNumber(rValue))
+    return toNumber(lValue) > toNumber(rValue);
+  return false;
+}
+
+auto lessOrEqual(Value lValue, Value rValue)->Value {
+  if (isNumber(lValue) && isNumber(rValue))
+    return toNumber(lValue) <= toNumber(rValue);
+  return false;
+}
+
+auto greaterOrEqual(Value lValue, Value rValue)->Value {
+  if (isNumber(lValue) && isNumber(rValue))
+    return toNumber(lValue) >= toNumber(rValue);
+  return false;
+}
+
+auto subtract(Value lValue, Value rValue)->Value {
+  if (isNumber(lValue) && isNumber(rValue))
+    return toNumber(lValue) - toNumber(rValue);
+  return 0.0;
+}
+
+auto multiply(Value lValue, Value rValue)->Value {
+  if (isNumber(lValue) && isNumber(rValue))
+    return toNumber(lValue) * toNumber(rValue);
+  return 0.0;
+}
+
+auto divide(Value lValue, Value rValue)->Value {
+  if (isNumber(lValue) && isNumber(rValue) && toNumber(rValue) == 0)
+    return 0.0;
+  if (isNumber(lValue) && isNumber(rValue))
+    return toNumber(lValue) / toNumber(rValue);
+  return 0.0;
+}
+
+auto modulo(Value lValue, Value rValue)->Value {
+  if (isNumber(lValue) && isNumber(rValue) && toNumber(rValue) == 0)
+    return 0.0;
+  if (isNumber(lValue) && isNumber(rValue))
+    return fmod(toNumber(lValue), toNumber(rValue));
+  return 0.0;
+}
+
+auto absolute(Value value)->Value {
+  if (isNumber(value))
+    return fabs(toNumber(value));
+  return 0.0;
+}
+
+auto reverseSign(Value value)->Value {
+  if (isNumber(value))
+    return toNumber(value) * -1;
+  return 0.0;
 }
 
-auto isBuiltinFunction(any value)->bool {
-  return value.type() == typeid(function<any(vector<any>)>);
+auto setSlotOfMap(Map* map, Key* key, Value value)->void {
+  if (map->shape != nullptr) {
+    auto slot = map->shape->slots.find(key);
+    if (slot != nullptr) {
+      map->fields[*slot] = value;
+      return;
+    }
+    auto shape = map->shape->slots.size() < Shape::MaxSize ? map->shape->getTransition(key) : nullptr;
+    if (shape != nullptr) {
+      map->shape = shape;
+      map->fields.push_back(value);
+      return;
+    }
+    toDictionary(map);
+  }
+  map->values[key] = value;
 }
 
-auto toBuiltinFunction(any value)->function<any(vector<any>)> {
-  return any_cast<function<any(vector<any>)>>(value);
+auto toDictionary(Map* map)->void {
+  for (auto& entry: map->shape->slots.entries)
+    map->values[entry.key] = map->fields[entry.value];
+  map->shape = nullptr;
+  map->fields.clear();
+  map->fields.shrink_to_fit();
 }
 
-auto operator<<(ostream& stream, any& value)->ostream& {
+auto operator<<(ostream& stream, Value& value)->ostream& {
   if (isNull(value)) {
     stream << "null";
   }
   else if (isBoolean(value)) {
-    stream << boolalpha << any_cast<bool>(value);
+    stream << boolalpha << toBoolean(value);
   }
   else if (isNumber(value)) {
     printf("%g", toNumber(value));
@@ -127,9 +238,16 @@ auto operator<<(ostream& stream, any& value)->ostream& {
     stream << "]";
   }
   else if (isMap(value)) {
+    vector<pair<const string*, Value>> entries;
+    forEachOfMap(value, [&](const string& key, Value& value) {
+      entries.push_back({&key, value});
+    });
+    sort(entries.begin(), entries.end(), [](auto& lhs, auto& rhs) {
+      return *lhs.first < *rhs.first;
+    });
     stream << "{ ";
-    for (auto& [key, value] : toMap(value)->values)
-      stream << key << ":" << value << " ";
+    for (auto& [key, value]: entries)
+      stream << *key << ":" << value << " ";
     stream << "}";
   }
   return stream;
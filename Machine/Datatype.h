@@ -1,62 +1,260 @@
 #pragma once
-#include <any>
 #include <map>
+#include <memory>
 #include <vector>
 #include <string>
+#include <cstdint>
+#include <cstring>
 #include <iostream>
 #include <functional>
-#include "Node.h"
+#include "HashMap.h"
 
-using std::any;
 using std::map;
 using std::vector;
 using std::string;
 using std::ostream;
 using std::function;
+using std::nullptr_t;
+using std::unique_ptr;
+
+struct String;
+struct Array;
+struct Map;
+
+enum class Tag: uint64_t {
+  Null = 1, Boolean, Size, String, Array, Map, BuiltinFunction,
+};
+
+struct Value {
+  static const uint64_t BoxMask = 0xFFF8000000000000;
+  static const uint64_t TagMask = 0x0007000000000000;
+  static const uint64_t PayloadMask = 0x0000FFFFFFFFFFFF;
+  static const uint64_t CanonicalNaN = 0x7FF8000000000000;
+
+  uint64_t bits;
+
+  Value(): Value(nullptr) {}
+  Value(nullptr_t): bits(box(Tag::Null, 0)) {}
+  Value(bool value): bits(box(Tag::Boolean, value)) {}
+  Value(size_t value): bits(box(Tag::Size, value)) {}
+  Value(double value) {
+    if (value != value) {
+      bits = CanonicalNaN;
+      return;
+    }
+    memcpy(&bits, &value, sizeof(bits));
+  }
+  Value(String*);
+  Value(Array*);
+  Value(Map*);
+  Value(function<Value(vector<Value>)>* value):
+    bits(box(Tag::BuiltinFunction, reinterpret_cast<uintptr_t>(value))) {}
+
+  static auto box(Tag tag, uint64_t payload)->uint64_t {
+    return BoxMask | static_cast<uint64_t>(tag) << 48 | (payload & PayloadMask);
+  }
+  auto is(Tag tag) const->bool {
+    return (bits & (BoxMask | TagMask)) == box(tag, 0);
+  }
+  auto payload() const->uint64_t {
+    return bits & PayloadMask;
+  }
+};
 
 struct Object {
   bool isMarked = false;
+  bool isOld = false;
+  bool isRemembered = false;
   virtual ~Object() {}
 };
 
+// 맵의 키로 쓰인 문자열은 키 표의 키를 붙잡아 두어 다음에 찾을 때 문자열을 해시하지 않는다.
+struct String: Object {
+  string value;
+  Key* key = nullptr;
+
+  ~String() {
+    if (key != nullptr)
+      releaseKey(key);
+  }
+};
+
 struct Array: Object {
-  vector<any> values;
+  vector<Value> values;
 };
 
+// 같은 키를 같은 순서로 더한 맵끼리 공유하는 키 배치다. 키를 하나 더하면
+// transitions를 따라 다음 모양으로 옮겨 가며, 모양은 자신에게서 뻗은 모양을 소유한다.
+// 모양은 해제하지 않으므로 한 모양에서 뻗을 수 있는 가지 수를 제한한다.
+struct Shape {
+  static const size_t MaxSize = 32;
+  static const size_t MaxTransitions = 16;
+
+  HashMap<size_t> slots;
+  HashMap<unique_ptr<Shape>> transitions;
+
+  auto getTransition(Key* key)->Shape*;
+};
+
+// shape가 있으면 값은 fields의 슬롯에 있고, 없으면 사전 모드로 values에 있다.
+// 키가 너무 많아지거나, 모양의 가지가 다 찼거나, 키를 지우면 사전 모드로 바뀐다.
 struct Map: Object {
-  map<string, any> values;
+  Shape* shape = nullptr;
+  vector<Value> fields;
+  HashMap<Value> values;
 };
 
-auto isSize(any value)->bool;
-auto toSize(any value)->size_t;
+inline Value::Value(String* value): bits(box(Tag::String, reinterpret_cast<uintptr_t>(static_cast<Object*>(value)))) {}
+inline Value::Value(Array* value): bits(box(Tag::Array, reinterpret_cast<uintptr_t>(static_cast<Object*>(value)))) {}
+inline Value::Value(Map* value): bits(box(Tag::Map, reinterpret_cast<uintptr_t>(static_cast<Object*>(value)))) {}
+
+inline auto isSize(Value value)->bool {
+  return value.is(Tag::Size);
+}
+
+inline auto toSize(Value value)->size_t {
+  return static_cast<size_t>(value.payload());
+}
+
+inline auto isNull(Value value)->bool {
+  return value.is(Tag::Null);
+}
 
-auto isNull(any value)->bool;
+inline auto isBoolean(Value value)->bool {
+  return value.is(Tag::Boolean);
+}
 
-auto isTrue(any value)->bool;
-auto isFalse(any value)->bool;
-auto isBoolean(any value)->bool;
-auto toBoolean(any value)->bool;
+inline auto toBoolean(Value value)->bool {
+  return value.payload() != 0;
+}
 
-auto isNumber(any value)->bool;
-auto toNumber(any value)->double;
+inline auto isTrue(Value value)->bool {
+  return value.bits == Value(true).bits;
+}
+
+inline auto isFalse(Value value)->bool {
+  return value.bits == Value(false).bits;
+}
+
+inline auto isNumber(Value value)->bool {
+  return (value.bits & Value::BoxMask) != Value::BoxMask;
+}
+
+inline auto toNumber(Value value)->double {
+  double result;
+  memcpy(&result, &value.bits, sizeof(result));
+  return result;
+}
+
+inline auto toObject(Value value)->Object* {
+  return reinterpret_cast<Object*>(value.payload());
+}
+
+inline auto isString(Value value)->bool {
+  return value.is(Tag::String);
+}
+
+inline auto toString(Value value)->string& {
+  return static_cast<String*>(toObject(value))->value;
+}
+
+// 키 표에 없는 문자열이면 널을 돌려준다.
+inline auto findKeyOf(Value value)->Key* {
+  auto object = static_cast<String*>(toObject(value));
+  if (object->key == nullptr) {
+    auto key = findKey(object->value);
+    if (key != nullptr)
+      object->key = retainKey(key);
+  }
+  return object->key;
+}
+
+inline auto internKeyOf(Value value)->Key* {
+  auto object = static_cast<String*>(toObject(value));
+  if (object->key == nullptr)
+    object->key = internKey(object->value);
+  return object->key;
+}
+
+inline auto isArray(Value value)->bool {
+  return value.is(Tag::Array);
+}
+
+inline auto toArray(Value value)->Array* {
+  return static_cast<Array*>(toObject(value));
+}
+
+inline auto isMap(Value value)->bool {
+  return value.is(Tag::Map);
+}
+
+inline auto toMap(Value value)->Map* {
+  return static_cast<Map*>(toObject(value));
+}
+
+inline auto isObject(Value value)->bool {
+  return isString(value) || isArray(value) || isMap(value);
+}
+
+inline auto isBuiltinFunction(Value value)->bool {
+  return value.is(Tag::BuiltinFunction);
+}
+
+inline auto toBuiltinFunction(Value value)->function<Value(vector<Value>)>& {
+  return *reinterpret_cast<function<Value(vector<Value>)>*>(value.payload());
+}
+
+struct GarbageCollectorOptions {
+  size_t nurserySize = 1 << 20;
+  size_t heapSize = 1 << 24;
+  double growthFactor = 2.0;
+  bool printStatistics = false;
+};
 
-auto isString(any value)->bool;
-auto toString(any value)->string;
+// 이 스레드에서 실행 중인 Isolate의 remembered set이다.
+extern thread_local vector<Value>* currentRememberedSet;
 
-auto isArray(any value)->bool;
-auto toArray(any value)->Array*;
-auto getValueOfArray(any object, any index)->any;
-auto setValueOfArray(any object, any index, any value)->any;
+inline auto writeBarrier(Value object, Value value)->void {
+  if (toObject(object)->isOld && isObject(value) && toObject(value)->isOld == false &&
+      toObject(object)->isRemembered == false) {
+    toObject(object)->isRemembered = true;
+    currentRememberedSet->push_back(object);
+  }
+}
 
-auto isMap(any value)->bool;
-auto toMap(any value)->Map*;
-auto getValueOfMap(any object, any key)->any;
-auto setValueOfMap(any object, any key, any value)->any;
+auto equal(Value, Value)->Value;
+auto notEqual(Value, Value)->Value;
+auto lessThan(Value, Value)->Value;
+auto greaterThan(Value, Value)->Value;
+auto lessOrEqual(Value, Value)->Value;
+auto greaterOrEqual(Value, Value)->Value;
+auto subtract(Value, Value)->Value;
+auto multiply(Value, Value)->Value;
+auto divide(Value, Value)->Value;
+auto modulo(Value, Value)->Value;
+auto absolute(Value)->Value;
+auto reverseSign(Value)->Value;
 
-auto isFunction(any)->bool;
-auto toFunction(any)->Function*;
+auto getValueOfArray(Value object, Value index)->Value;
+auto setValueOfArray(Value object, Value index, Value value)->Value;
+auto getValueOfMap(Value object, Value key)->Value;
+auto setValueOfMap(Value object, Value key, Value value)->Value;
+auto hasKeyOfMap(Value object, Value key)->bool;
+auto eraseKeyOfMap(Value object, Value key)->void;
+auto getSizeOfMap(Value object)->size_t;
+auto getElement(Value sub, Value index)->Value;
+auto setElement(Value sub, Value index, Value value)->void;
 
-auto isBuiltinFunction(any value)->bool;
-auto toBuiltinFunction(any value)->function<any(vector<any>)>;
+template<typename Function>
+inline auto forEachOfMap(Value object, Function function)->void {
+  auto map = toMap(object);
+  if (map->shape == nullptr) {
+    map->values.forEach(function);
+    return;
+  }
+  map->shape->slots.forEach([&](const string& key, size_t slot) {
+    function(key, map->fields[slot]);
+  });
+}
 
-auto operator<<(ostream& stream, any& value)->ostream&;
+auto operator<<(ostream& stream, Value& value)->ostream&;
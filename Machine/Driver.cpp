@@ -0,0 +1,67 @@
+﻿#include <map>
+#include <fstream>
+#include "Main.h"
+#include "Parallel.h"
+#include "SourceFile.h"
+
+using std::map;
+using std::cout;
+using std::endl;
+using std::move;
+using std::ifstream;
+using std::make_unique;
+
+static auto parseFile(string, bool, string&)->unique_ptr<Program>;
+
+// 파일마다 독립적으로 스캔하고 파싱하므로 여러 파일을 여러 스레드에서 동시에 처리한다.
+// 각 파일의 구문 트리는 합친 프로그램의 modules가 소유한다. 작업자가 모두 끝난 뒤에
+// 오류가 난 파일을 모두 경로와 함께 출력하고 끝낸다.
+auto parseFiles(vector<string> paths, bool isStreaming)->unique_ptr<Program> {
+  vector<unique_ptr<Program>> modules(paths.size());
+  vector<string> errors(paths.size());
+  parallelFor(paths.size(), [&](size_t i) {
+    modules[i] = parseFile(paths[i], isStreaming, errors[i]);
+  });
+  auto hasError = false;
+  for (size_t i = 0; i < paths.size(); i++) {
+    if (errors[i].empty())
+      continue;
+    cout << paths[i] << ": " << errors[i] << endl;
+    hasError = true;
+  }
+  if (hasError)
+    exit(1);
+  if (modules.size() == 1)
+    return move(modules.front());
+  auto result = make_unique<Program>();
+  map<string, size_t> functionTable;
+  for (size_t i = 0; i < modules.size(); i++) {
+    for (auto& function: modules[i]->functions) {
+      auto iterator = functionTable.emplace(function->name, i).first;
+      if (iterator->second != i) {
+        cout << function->name << " 함수가 " << paths[iterator->second] << " 파일과 " << paths[i] << " 파일에 중복 정의되었습니다.";
+        exit(1);
+      }
+      result->functions.push_back(function);
+    }
+    result->modules.push_back(move(modules[i]));
+  }
+  return result;
+}
+
+auto parseFile(string path, bool isStreaming, string& error)->unique_ptr<Program> {
+  try {
+    if (isStreaming) {
+      ifstream stream(path, ifstream::binary);
+      if (stream.is_open() == false)
+        throw SourceError{"파일을 열 수 없습니다."};
+      return parse(scanStream(stream));
+    }
+    SourceFile sourceFile(path);
+    return parse(scan(sourceFile.view()));
+  }
+  catch (SourceError& exception) {
+    error = exception.message;
+    return nullptr;
+  }
+}
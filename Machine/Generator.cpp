@@ -5,6 +5,7 @@
 #include <iomanip>
 #include "Node.h"
 #include "Code.h"
+#include "Parallel.h"
 
 using std::max;
 using std::cout;
@@ -13,72 +14,147 @@ using std::endl;
 using std::map;
 using std::list;
 using std::tuple;
+using std::move;
 using std::vector;
 
-static auto getLocal(string)->size_t;
-static auto setLocal(string)->void;
-static auto initBlock()->void;
-static auto pushBlock()->void;
-static auto popBlock()->void;
-static auto writeCode(Instruction)->size_t;
-static auto writeCode(Instruction, any)->size_t;
-static auto patchAddress(size_t)->void;
-static auto patchOperand(size_t, size_t)->void;
-
-static vector<Code> codeList;
-static map<string, size_t> functionTable;
-static list<map<string, size_t>> symbolStack;
-static vector<size_t> offsetStack;
-static size_t localSize;
-static vector<vector<size_t>> continueStack;
-static vector<vector<size_t>> breakStack;
-
-auto generate(Program* program)->tuple<vector<Code>, map<string, size_t>> {
-  codeList.clear();
-  functionTable.clear();
-  writeCode(Instruction::GetGlobal, string("main"));
-  writeCode(Instruction::Call, static_cast<size_t>(0));
-  writeCode(Instruction::Exit);
-  for (auto& node: program->functions)
-    node->generate();
-  return {codeList, functionTable};
-}
-
-auto Function::generate()->void {
-  functionTable[name] = codeList.size();
-  auto temp = writeCode(Instruction::Alloca);
-  initBlock();
+struct Fragment {
+  string name;
+  vector<uint8_t> codeList;
+  vector<Value> constantList;
+  vector<For*> loops;
+  vector<size_t> loopAddresses;
+};
+
+// 코드 생성 상태는 함수마다 새로 만들므로 여러 스레드에서 동시에 코드를 생성할 수 있다.
+struct CodeGenContext {
+  vector<uint8_t> codeList;
+  vector<Value> constantList;
+  map<double, size_t> numberTable;
+  map<string, size_t> stringTable;
+  map<string, size_t> functionTable;
+  list<map<string, size_t>> symbolStack;
+  vector<size_t> offsetStack;
+  size_t localSize = 0;
+  vector<vector<size_t>> continueStack;
+  vector<vector<size_t>> breakStack;
+  vector<For*> loops;
+  vector<size_t> loopAddresses;
+
+  auto appendFragment(Fragment&)->void;
+  auto appendRegisterFragment(Fragment&)->void;
+  auto relocateConstants(Fragment&)->vector<size_t>;
+  auto getLocal(string)->size_t;
+  auto setLocal(string)->void;
+  auto initBlock()->void;
+  auto pushBlock()->void;
+  auto popBlock()->void;
+  auto generateCountedLoop(For*)->bool;
+  auto allocateRegister()->size_t;
+  auto allocateRegisters(size_t)->size_t;
+  auto toRegister(Expression*, bool = true)->size_t;
+  auto writeCode(Instruction)->size_t;
+  auto writeCode(Instruction, size_t)->size_t;
+  auto writeCode(Instruction, vector<size_t>)->size_t;
+  auto writeCode(RegisterInstruction, vector<size_t> = {})->size_t;
+  auto toConstant(double)->size_t;
+  auto toConstant(string)->size_t;
+  auto patchAddress(size_t)->void;
+  auto patchOperand(size_t, size_t)->void;
+};
+
+static auto generateFragments(Program*, bool)->vector<Fragment>;
+static auto isAssigning(Expression*)->bool;
+
+auto generate(Program* program)->ObjectCode {
+  auto fragments = generateFragments(program, false);
+  CodeGenContext context;
+  context.writeCode(Instruction::GetGlobal, context.toConstant(string("main")));
+  context.writeCode(Instruction::Call, static_cast<size_t>(0));
+  context.writeCode(Instruction::Exit);
+  for (auto& fragment: fragments)
+    context.appendFragment(fragment);
+  return {context.codeList, context.constantList, context.functionTable};
+}
+
+auto Function::generate(CodeGenContext& context)->void {
+  context.functionTable[name] = context.codeList.size();
+  auto temp = context.writeCode(Instruction::Alloca);
+  context.initBlock();
   for (auto& name: parameters)
-    setLocal(name);
+    context.setLocal(name);
   for (auto& node: block)
-    node->generate();
-  popBlock();
-  patchOperand(temp, localSize);
-  writeCode(Instruction::Return);
-}
-
-auto Variable::generate()->void {
-  setLocal(name);
-  expression->generate();
-  writeCode(Instruction::SetLocal, getLocal(name));
-  writeCode(Instruction::PopOperand);
-}
-
-auto For::generate()->void {
-  breakStack.emplace_back();
-  continueStack.emplace_back();
-  pushBlock();
-  variable->generate();
-  auto jumpAddress = codeList.size();
-  condition->generate();
-  auto conditionJump = writeCode(Instruction::ConditionJump);
+    node->generate(context);
+  context.popBlock();
+  context.patchOperand(temp, context.localSize);
+  context.writeCode(Instruction::PushNull);
+  context.writeCode(Instruction::Return);
+}
+
+auto Variable::generate(CodeGenContext& context)->void {
+  context.setLocal(name);
+  expression->generate(context);
+  context.writeCode(Instruction::SetLocal, context.getLocal(name));
+  context.writeCode(Instruction::PopOperand);
+}
+
+auto For::generate(CodeGenContext& context)->void {
+  context.breakStack.emplace_back();
+  context.continueStack.emplace_back();
+  context.pushBlock();
+  variable->generate(context);
+  if (context.generateCountedLoop(this))
+    return;
+  auto jumpAddress = context.codeList.size();
+  context.loops.push_back(this);
+  context.loopAddresses.push_back(jumpAddress);
+  condition->generate(context);
+  auto conditionJump = context.writeCode(Instruction::ConditionJump);
   for (auto& node: block)
-    node->generate();
+    node->generate(context);
+  auto continueAddress = context.codeList.size();
+  expression->generate(context);
+  context.writeCode(Instruction::PopOperand);
+  context.writeCode(Instruction::Jump, jumpAddress);
+  context.patchAddress(conditionJump);
+  context.popBlock();
+  for (auto& jump: context.continueStack.back())
+    context.patchOperand(jump, continueAddress);
+  context.continueStack.pop_back();
+  for (auto& jump: context.breakStack.back())
+    context.patchAddress(jump);
+  context.breakStack.pop_back();
+}
+
+// 조건이 '지역 변수 < 숫자 또는 지역 변수'인 반복문은 검사를 끝으로 옮겨 한 명령으로
+// 비교하고 되돌아간다. 증가식은 틈새 최적화에서 IncLocal이 된다. 검사는 본문 뒤에
+// 생성하지만 변수의 칸은 본문 앞에서 정해 두어 본문의 선언이 조건을 가리지 않게 한다.
+auto CodeGenContext::generateCountedLoop(For* node)->bool {
+  auto relational = dynamic_cast<Relational*>(node->condition);
+  if (relational == nullptr || relational->kind != Kind::LessThan)
+    return false;
+  auto lhs = dynamic_cast<GetVariable*>(relational->lhs);
+  if (lhs == nullptr || getLocal(lhs->name) == SIZE_MAX)
+    return false;
+  auto number = dynamic_cast<NumberLiteral*>(relational->rhs);
+  auto rhs = dynamic_cast<GetVariable*>(relational->rhs);
+  if (number == nullptr && (rhs == nullptr || getLocal(rhs->name) == SIZE_MAX))
+    return false;
+  auto lhsSlot = getLocal(lhs->name);
+  auto rhsSlot = rhs != nullptr ? getLocal(rhs->name) : SIZE_MAX;
+  auto testJump = writeCode(Instruction::Jump);
+  auto bodyAddress = codeList.size();
+  for (auto& node: node->block)
+    node->generate(*this);
   auto continueAddress = codeList.size();
-  expression->generate();
+  node->expression->generate(*this);
   writeCode(Instruction::PopOperand);
-  writeCode(Instruction::Jump, jumpAddress);
-  patchAddress(conditionJump);
+  patchAddress(testJump);
+  loops.push_back(node);
+  loopAddresses.push_back(codeList.size());
+  if (number != nullptr)
+    writeCode(Instruction::LessThanLocalConstantJump, {bodyAddress, lhsSlot, toConstant(number->value)});
+  else
+    writeCode(Instruction::LessThanLocalLocalJump, {bodyAddress, lhsSlot, rhsSlot});
   popBlock();
   for (auto& jump: continueStack.back())
     patchOperand(jump, continueAddress);
@@ -86,75 +162,76 @@ auto For::generate()->void {
   for (auto& jump: breakStack.back())
     patchAddress(jump);
   breakStack.pop_back();
+  return true;
 }
 
-auto Continue::generate()->void {
-  if (continueStack.empty()) return;
-  auto jumpCode = writeCode(Instruction::Jump);
-  continueStack.back().push_back(jumpCode);
+auto Continue::generate(CodeGenContext& context)->void {
+  if (context.continueStack.empty()) return;
+  auto jumpCode = context.writeCode(Instruction::Jump);
+  context.continueStack.back().push_back(jumpCode);
 }
 
-auto Break::generate()->void {
-  if (breakStack.empty()) return;
-  auto jumpCode = writeCode(Instruction::Jump);
-  breakStack.back().push_back(jumpCode);
+auto Break::generate(CodeGenContext& context)->void {
+  if (context.breakStack.empty()) return;
+  auto jumpCode = context.writeCode(Instruction::Jump);
+  context.breakStack.back().push_back(jumpCode);
 }
 
-auto If::generate()->void {
+auto If::generate(CodeGenContext& context)->void {
   vector<size_t> jumpList;
   for (size_t i = 0; i < conditions.size(); i++) {
-    conditions[i]->generate();
-    auto conditionJump = writeCode(Instruction::ConditionJump);
-    pushBlock();
+    conditions[i]->generate(context);
+    auto conditionJump = context.writeCode(Instruction::ConditionJump);
+    context.pushBlock();
     for (auto& node: blocks[i])
-      node->generate();
-    popBlock();
-    jumpList.push_back(writeCode(Instruction::Jump));
-    patchAddress(conditionJump);
+      node->generate(context);
+    context.popBlock();
+    jumpList.push_back(context.writeCode(Instruction::Jump));
+    context.patchAddress(conditionJump);
   }
   if (elseBlock.empty() == false) {
-    pushBlock();
+    context.pushBlock();
     for (auto& node: elseBlock)
-      node->generate();
-    popBlock();
+      node->generate(context);
+    context.popBlock();
   }
   for (auto& jump: jumpList)
-    patchAddress(jump);
+    context.patchAddress(jump);
 }
 
-auto Print::generate()->void {
+auto Print::generate(CodeGenContext& context)->void {
   for (auto i = arguments.size(); i > 0; i--)
-    arguments[i - 1]->generate();
-  writeCode(Instruction::Print, arguments.size());
+    arguments[i - 1]->generate(context);
+  context.writeCode(Instruction::Print, arguments.size());
   if (lineFeed)
-    writeCode(Instruction::PrintLine);
+    context.writeCode(Instruction::PrintLine);
 }
 
-auto Return::generate()->void {
-  expression->generate();
-  writeCode(Instruction::Return);
+auto Return::generate(CodeGenContext& context)->void {
+  expression->generate(context);
+  context.writeCode(Instruction::Return);
 }
 
-auto ExpressionStatement::generate()->void {
-  expression->generate();
-  writeCode(Instruction::PopOperand);
+auto ExpressionStatement::generate(CodeGenContext& context)->void {
+  expression->generate(context);
+  context.writeCode(Instruction::PopOperand);
 }
 
-auto Or::generate()->void {
-  lhs->generate();
-  auto logicalOr = writeCode(Instruction::LogicalOr);
-  rhs->generate();
-  patchAddress(logicalOr);
+auto Or::generate(CodeGenContext& context)->void {
+  lhs->generate(context);
+  auto logicalOr = context.writeCode(Instruction::LogicalOr);
+  rhs->generate(context);
+  context.patchAddress(logicalOr);
 }
 
-auto And::generate()->void {
-  lhs->generate();
-  auto logicalAnd = writeCode(Instruction::LogicalAnd);
-  rhs->generate();
-  patchAddress(logicalAnd);
+auto And::generate(CodeGenContext& context)->void {
+  lhs->generate(context);
+  auto logicalAnd = context.writeCode(Instruction::LogicalAnd);
+  rhs->generate(context);
+  context.patchAddress(logicalAnd);
 }
 
-auto Relational::generate()->void {
+auto Relational::generate(CodeGenContext& context)->void {
   map<Kind, Instruction> instructions = {
     {Kind::Equal,          Instruction::Equal},
     {Kind::NotEqual,       Instruction::NotEqual},
@@ -163,12 +240,12 @@ auto Relational::generate()->void {
     {Kind::LessOrEqual,    Instruction::LessOrEqual},
     {Kind::GreaterOrEqual, Instruction::GreaterOrEqual}
   };
-  lhs->generate();
-  rhs->generate();
-  writeCode(instructions[kind]);
+  lhs->generate(context);
+  rhs->generate(context);
+  context.writeCode(instructions[kind]);
 }
 
-auto Arithmetic::generate()->void {
+auto Arithmetic::generate(CodeGenContext& context)->void {
   map<Kind, Instruction> instructions = {
     {Kind::Add,      Instruction::Add},
     {Kind::Subtract, Instruction::Subtract},
@@ -176,86 +253,468 @@ auto Arithmetic::generate()->void {
     {Kind::Divide,   Instruction::Divide},
     {Kind::Modulo,   Instruction::Modulo},
   };
-  lhs->generate();
-  rhs->generate();
-  writeCode(instructions[kind]);
+  lhs->generate(context);
+  rhs->generate(context);
+  context.writeCode(instructions[kind]);
 }
 
-auto Unary::generate()->void {
+auto Unary::generate(CodeGenContext& context)->void {
   map<Kind, Instruction> instructions = {
     {Kind::Add,      Instruction::Absolute},
     {Kind::Subtract, Instruction::ReverseSign}
   };
-  sub->generate();
-  writeCode(instructions[kind]);
+  sub->generate(context);
+  context.writeCode(instructions[kind]);
 }
 
-auto Call::generate()->void {
-  for (auto i = arguments.size(); i > 0; i--)
-    arguments[i - 1]->generate();
-  sub->generate();
-  writeCode(Instruction::Call, arguments.size());
+auto Call::generate(CodeGenContext& context)->void {
+  for (auto& node: arguments)
+    node->generate(context);
+  sub->generate(context);
+  context.writeCode(Instruction::Call, arguments.size());
 }
 
-auto GetElement::generate()->void {
-  sub->generate();
-  index->generate();
-  writeCode(Instruction::GetElement);
+auto GetElement::generate(CodeGenContext& context)->void {
+  sub->generate(context);
+  index->generate(context);
+  context.writeCode(Instruction::GetElement);
 }
 
-auto SetElement::generate()->void {
-  value->generate();
-  sub->generate();
-  index->generate();
-  writeCode(Instruction::SetElement);
+auto SetElement::generate(CodeGenContext& context)->void {
+  value->generate(context);
+  sub->generate(context);
+  index->generate(context);
+  context.writeCode(Instruction::SetElement);
 }
 
-auto NullLiteral::generate()->void {
-  writeCode(Instruction::PushNull);
+auto NullLiteral::generate(CodeGenContext& context)->void {
+  context.writeCode(Instruction::PushNull);
 }
 
-auto BooleanLiteral::generate()->void {
-  writeCode(Instruction::PushBoolean, value);
+auto BooleanLiteral::generate(CodeGenContext& context)->void {
+  context.writeCode(Instruction::PushBoolean, static_cast<size_t>(value));
 }
 
-auto NumberLiteral::generate()->void {
-  writeCode(Instruction::PushNumber, value);
+auto NumberLiteral::generate(CodeGenContext& context)->void {
+  context.writeCode(Instruction::PushNumber, context.toConstant(value));
 }
 
-auto StringLiteral::generate()->void {
-  writeCode(Instruction::PushString, value);
+auto StringLiteral::generate(CodeGenContext& context)->void {
+  context.writeCode(Instruction::PushString, context.toConstant(value));
 }
 
-auto ArrayLiteral::generate()->void {
+auto ArrayLiteral::generate(CodeGenContext& context)->void {
   for (auto i = values.size(); i > 0; i--)
-    values[i - 1]->generate();
-  writeCode(Instruction::PushArray, values.size());
+    values[i - 1]->generate(context);
+  context.writeCode(Instruction::PushArray, values.size());
 }
 
-auto MapLiteral::generate()->void {
+auto MapLiteral::generate(CodeGenContext& context)->void {
   for (auto& [key, value]: values) {
-    writeCode(Instruction::PushString, key);
-    value->generate();
+    context.writeCode(Instruction::PushString, context.toConstant(key));
+    value->generate(context);
   }
-  writeCode(Instruction::PushMap, values.size());
+  context.writeCode(Instruction::PushMap, values.size());
 }
 
-auto GetVariable::generate()->void {
-  if (getLocal(name) == SIZE_MAX)
-    writeCode(Instruction::GetGlobal, name);
+auto GetVariable::generate(CodeGenContext& context)->void {
+  if (context.getLocal(name) == SIZE_MAX)
+    context.writeCode(Instruction::GetGlobal, context.toConstant(name));
   else
-    writeCode(Instruction::GetLocal, getLocal(name));
+    context.writeCode(Instruction::GetLocal, context.getLocal(name));
 }
 
-auto SetVariable::generate()->void {
-  value->generate();
-  if (getLocal(name) == SIZE_MAX)
-    writeCode(Instruction::SetGlobal, name);
+auto SetVariable::generate(CodeGenContext& context)->void {
+  value->generate(context);
+  if (context.getLocal(name) == SIZE_MAX)
+    context.writeCode(Instruction::SetGlobal, context.toConstant(name));
   else
-    writeCode(Instruction::SetLocal, getLocal(name));
+    context.writeCode(Instruction::SetLocal, context.getLocal(name));
+}
+
+auto generateRegister(Program* program)->ObjectCode {
+  auto fragments = generateFragments(program, true);
+  CodeGenContext context;
+  context.writeCode(RegisterInstruction::Alloca, {2});
+  context.writeCode(RegisterInstruction::GetGlobal, {1, context.toConstant(string("main"))});
+  context.writeCode(RegisterInstruction::Call, {0, 1, 2, 0});
+  context.writeCode(RegisterInstruction::Exit);
+  for (auto& fragment: fragments)
+    context.appendRegisterFragment(fragment);
+  return {context.codeList, context.constantList, context.functionTable};
+}
+
+auto Function::generateRegister(CodeGenContext& context)->void {
+  context.functionTable[name] = context.codeList.size();
+  auto temp = context.writeCode(RegisterInstruction::Alloca);
+  context.initBlock();
+  for (auto& name: parameters)
+    context.setLocal(name);
+  for (auto& node: block)
+    node->generateRegister(context);
+  auto result = context.allocateRegister();
+  context.writeCode(RegisterInstruction::LoadNull, {result});
+  context.writeCode(RegisterInstruction::Return, {result});
+  context.popBlock();
+  context.patchOperand(temp, context.localSize);
+}
+
+auto Variable::generateRegister(CodeGenContext& context)->void {
+  context.setLocal(name);
+  expression->generateRegister(context, context.getLocal(name));
+}
+
+auto For::generateRegister(CodeGenContext& context)->void {
+  context.breakStack.emplace_back();
+  context.continueStack.emplace_back();
+  context.pushBlock();
+  variable->generateRegister(context);
+  auto offset = context.offsetStack.back();
+  auto jumpAddress = context.codeList.size();
+  auto result = context.toRegister(condition);
+  auto conditionJump = context.writeCode(RegisterInstruction::ConditionJump, {0, result});
+  context.offsetStack.back() = offset;
+  for (auto& node: block)
+    node->generateRegister(context);
+  auto continueAddress = context.codeList.size();
+  context.toRegister(expression);
+  context.offsetStack.back() = offset;
+  context.writeCode(RegisterInstruction::Jump, {jumpAddress});
+  context.patchAddress(conditionJump);
+  context.popBlock();
+  for (auto& jump: context.continueStack.back())
+    context.patchOperand(jump, continueAddress);
+  context.continueStack.pop_back();
+  for (auto& jump: context.breakStack.back())
+    context.patchAddress(jump);
+  context.breakStack.pop_back();
+}
+
+auto Continue::generateRegister(CodeGenContext& context)->void {
+  if (context.continueStack.empty()) return;
+  auto jumpCode = context.writeCode(RegisterInstruction::Jump);
+  context.continueStack.back().push_back(jumpCode);
+}
+
+auto Break::generateRegister(CodeGenContext& context)->void {
+  if (context.breakStack.empty()) return;
+  auto jumpCode = context.writeCode(RegisterInstruction::Jump);
+  context.breakStack.back().push_back(jumpCode);
+}
+
+auto If::generateRegister(CodeGenContext& context)->void {
+  vector<size_t> jumpList;
+  for (size_t i = 0; i < conditions.size(); i++) {
+    auto offset = context.offsetStack.back();
+    auto result = context.toRegister(conditions[i]);
+    auto conditionJump = context.writeCode(RegisterInstruction::ConditionJump, {0, result});
+    context.offsetStack.back() = offset;
+    context.pushBlock();
+    for (auto& node: blocks[i])
+      node->generateRegister(context);
+    context.popBlock();
+    jumpList.push_back(context.writeCode(RegisterInstruction::Jump));
+    context.patchAddress(conditionJump);
+  }
+  if (elseBlock.empty() == false) {
+    context.pushBlock();
+    for (auto& node: elseBlock)
+      node->generateRegister(context);
+    context.popBlock();
+  }
+  for (auto& jump: jumpList)
+    context.patchAddress(jump);
+}
+
+auto Print::generateRegister(CodeGenContext& context)->void {
+  auto offset = context.offsetStack.back();
+  auto base = context.allocateRegisters(arguments.size());
+  for (auto i = arguments.size(); i > 0; i--)
+    arguments[i - 1]->generateRegister(context, base + i - 1);
+  context.writeCode(RegisterInstruction::Print, {base, arguments.size()});
+  context.offsetStack.back() = offset;
+  if (lineFeed)
+    context.writeCode(RegisterInstruction::PrintLine);
+}
+
+auto Return::generateRegister(CodeGenContext& context)->void {
+  auto offset = context.offsetStack.back();
+  context.writeCode(RegisterInstruction::Return, {context.toRegister(expression)});
+  context.offsetStack.back() = offset;
+}
+
+auto ExpressionStatement::generateRegister(CodeGenContext& context)->void {
+  auto offset = context.offsetStack.back();
+  context.toRegister(expression);
+  context.offsetStack.back() = offset;
+}
+
+auto Or::generateRegister(CodeGenContext& context, size_t target)->void {
+  auto offset = context.offsetStack.back();
+  auto result = context.allocateRegister();
+  lhs->generateRegister(context, result);
+  auto logicalOr = context.writeCode(RegisterInstruction::LogicalOr, {0, result});
+  rhs->generateRegister(context, result);
+  context.patchAddress(logicalOr);
+  context.writeCode(RegisterInstruction::Move, {target, result});
+  context.offsetStack.back() = offset;
+}
+
+auto And::generateRegister(CodeGenContext& context, size_t target)->void {
+  auto offset = context.offsetStack.back();
+  auto result = context.allocateRegister();
+  lhs->generateRegister(context, result);
+  auto logicalAnd = context.writeCode(RegisterInstruction::LogicalAnd, {0, result});
+  rhs->generateRegister(context, result);
+  context.patchAddress(logicalAnd);
+  context.writeCode(RegisterInstruction::Move, {target, result});
+  context.offsetStack.back() = offset;
+}
+
+auto Relational::generateRegister(CodeGenContext& context, size_t target)->void {
+  map<Kind, RegisterInstruction> instructions = {
+    {Kind::Equal,          RegisterInstruction::Equal},
+    {Kind::NotEqual,       RegisterInstruction::NotEqual},
+    {Kind::LessThan,       RegisterInstruction::LessThan},
+    {Kind::GreaterThan,    RegisterInstruction::GreaterThan},
+    {Kind::LessOrEqual,    RegisterInstruction::LessOrEqual},
+    {Kind::GreaterOrEqual, RegisterInstruction::GreaterOrEqual}
+  };
+  auto offset = context.offsetStack.back();
+  auto lValue = context.toRegister(lhs, isAssigning(rhs) == false);
+  auto rValue = context.toRegister(rhs);
+  context.writeCode(instructions[kind], {target, lValue, rValue});
+  context.offsetStack.back() = offset;
+}
+
+auto Arithmetic::generateRegister(CodeGenContext& context, size_t target)->void {
+  map<Kind, RegisterInstruction> instructions = {
+    {Kind::Add,      RegisterInstruction::Add},
+    {Kind::Subtract, RegisterInstruction::Subtract},
+    {Kind::Multiply, RegisterInstruction::Multiply},
+    {Kind::Divide,   RegisterInstruction::Divide},
+    {Kind::Modulo,   RegisterInstruction::Modulo},
+  };
+  auto offset = context.offsetStack.back();
+  auto lValue = context.toRegister(lhs, isAssigning(rhs) == false);
+  auto rValue = context.toRegister(rhs);
+  context.writeCode(instructions[kind], {target, lValue, rValue});
+  context.offsetStack.back() = offset;
+}
+
+auto Unary::generateRegister(CodeGenContext& context, size_t target)->void {
+  map<Kind, RegisterInstruction> instructions = {
+    {Kind::Add,      RegisterInstruction::Absolute},
+    {Kind::Subtract, RegisterInstruction::ReverseSign}
+  };
+  auto offset = context.offsetStack.back();
+  context.writeCode(instructions[kind], {target, context.toRegister(sub)});
+  context.offsetStack.back() = offset;
+}
+
+auto Call::generateRegister(CodeGenContext& context, size_t target)->void {
+  auto offset = context.offsetStack.back();
+  auto callee = context.toRegister(sub, false);
+  auto base = context.allocateRegisters(arguments.size());
+  for (size_t i = 0; i < arguments.size(); i++)
+    arguments[i]->generateRegister(context, base + i);
+  context.writeCode(RegisterInstruction::Call, {target, callee, base, arguments.size()});
+  context.offsetStack.back() = offset;
+}
+
+auto GetElement::generateRegister(CodeGenContext& context, size_t target)->void {
+  auto offset = context.offsetStack.back();
+  auto object = context.toRegister(sub, isAssigning(index) == false);
+  auto index_ = context.toRegister(index);
+  context.writeCode(RegisterInstruction::GetElement, {target, object, index_});
+  context.offsetStack.back() = offset;
+}
+
+auto SetElement::generateRegister(CodeGenContext& context, size_t target)->void {
+  auto offset = context.offsetStack.back();
+  auto value_ = context.toRegister(value, isAssigning(sub) == false && isAssigning(index) == false);
+  auto object = context.toRegister(sub, isAssigning(index) == false);
+  auto index_ = context.toRegister(index);
+  context.writeCode(RegisterInstruction::SetElement, {object, index_, value_});
+  if (value_ != target)
+    context.writeCode(RegisterInstruction::Move, {target, value_});
+  context.offsetStack.back() = offset;
+}
+
+auto GetVariable::generateRegister(CodeGenContext& context, size_t target)->void {
+  if (context.getLocal(name) == SIZE_MAX)
+    context.writeCode(RegisterInstruction::GetGlobal, {target, context.toConstant(name)});
+  else if (context.getLocal(name) != target)
+    context.writeCode(RegisterInstruction::Move, {target, context.getLocal(name)});
+}
+
+auto SetVariable::generateRegister(CodeGenContext& context, size_t target)->void {
+  if (context.getLocal(name) == SIZE_MAX) {
+    value->generateRegister(context, target);
+    context.writeCode(RegisterInstruction::SetGlobal, {context.toConstant(name), target});
+    return;
+  }
+  value->generateRegister(context, context.getLocal(name));
+  if (context.getLocal(name) != target)
+    context.writeCode(RegisterInstruction::Move, {target, context.getLocal(name)});
+}
+
+auto NullLiteral::generateRegister(CodeGenContext& context, size_t target)->void {
+  context.writeCode(RegisterInstruction::LoadNull, {target});
+}
+
+auto BooleanLiteral::generateRegister(CodeGenContext& context, size_t target)->void {
+  context.writeCode(RegisterInstruction::LoadBoolean, {target, static_cast<size_t>(value)});
 }
 
-auto getLocal(string name)->size_t {
+auto NumberLiteral::generateRegister(CodeGenContext& context, size_t target)->void {
+  context.writeCode(RegisterInstruction::LoadConstant, {target, context.toConstant(value)});
+}
+
+auto StringLiteral::generateRegister(CodeGenContext& context, size_t target)->void {
+  context.writeCode(RegisterInstruction::LoadConstant, {target, context.toConstant(value)});
+}
+
+auto ArrayLiteral::generateRegister(CodeGenContext& context, size_t target)->void {
+  auto offset = context.offsetStack.back();
+  auto base = context.allocateRegisters(values.size());
+  for (auto i = values.size(); i > 0; i--)
+    values[i - 1]->generateRegister(context, base + i - 1);
+  context.writeCode(RegisterInstruction::NewArray, {target, base, values.size()});
+  context.offsetStack.back() = offset;
+}
+
+auto MapLiteral::generateRegister(CodeGenContext& context, size_t target)->void {
+  auto offset = context.offsetStack.back();
+  auto base = context.allocateRegisters(values.size() * 2);
+  auto index = base;
+  for (auto& [key, value]: values) {
+    context.writeCode(RegisterInstruction::LoadConstant, {index, context.toConstant(key)});
+    value->generateRegister(context, index + 1);
+    index += 2;
+  }
+  context.writeCode(RegisterInstruction::NewMap, {target, base, values.size()});
+  context.offsetStack.back() = offset;
+}
+
+// 함수마다 빈 목적 코드에서 따로 생성하므로 함수들을 여러 스레드에서 동시에 생성할 수 있다.
+// 조각의 주소는 0부터 시작하고 상수 번호는 조각의 상수 목록을 가리킨다.
+auto generateFragments(Program* program, bool isRegister)->vector<Fragment> {
+  vector<Fragment> result(program->functions.size());
+  parallelFor(result.size(), [&](size_t i) {
+    auto function = program->functions[i];
+    CodeGenContext context;
+    if (isRegister)
+      function->generateRegister(context);
+    else {
+      function->generate(context);
+      optimizeCode(context.codeList, context.loopAddresses);
+    }
+    result[i] = {function->name, move(context.codeList), move(context.constantList), move(context.loops), move(context.loopAddresses)};
+  });
+  return result;
+}
+
+// 조각을 목적 코드의 끝에 붙이고 주소와 상수 번호를 목적 코드 기준으로 고친다.
+// 반복문 노드에는 검사 코드의 주소를 남겨 계층 실행이 반복 도중에 넘어올 수 있게 한다.
+auto CodeGenContext::appendFragment(Fragment& fragment)->void {
+  auto base = codeList.size();
+  auto constants = relocateConstants(fragment);
+  functionTable[fragment.name] = base;
+  codeList.insert(codeList.end(), fragment.codeList.begin(), fragment.codeList.end());
+  for (size_t i = 0; i < fragment.loops.size(); i++)
+    fragment.loops[i]->address = base + fragment.loopAddresses[i];
+  for (auto i = base; i < codeList.size(); i += 1 + getOperandSize(static_cast<Instruction>(codeList[i]))) {
+    switch (static_cast<Instruction>(codeList[i])) {
+      case Instruction::Jump:
+      case Instruction::ConditionJump:
+      case Instruction::LogicalOr:
+      case Instruction::LogicalAnd:
+      case Instruction::EqualJump:
+      case Instruction::NotEqualJump:
+      case Instruction::LessThanJump:
+      case Instruction::GreaterThanJump:
+      case Instruction::LessOrEqualJump:
+      case Instruction::GreaterOrEqualJump: {
+        patchOperand(i, readOperand(&codeList[i + 1]) + base);
+        break;
+      }
+      case Instruction::GetGlobal:
+      case Instruction::SetGlobal:
+      case Instruction::PushNumber:
+      case Instruction::PushString:
+      case Instruction::AddNumber:
+      case Instruction::GetField:
+      case Instruction::SetField: {
+        patchOperand(i, constants[readOperand(&codeList[i + 1])]);
+        break;
+      }
+      case Instruction::IncLocal: {
+        writeOperand(&codeList[i + 5], constants[readOperand(&codeList[i + 5])]);
+        break;
+      }
+      case Instruction::LessThanLocalConstantJump: {
+        patchOperand(i, readOperand(&codeList[i + 1]) + base);
+        writeOperand(&codeList[i + 9], constants[readOperand(&codeList[i + 9])]);
+        break;
+      }
+      case Instruction::LessThanLocalLocalJump: {
+        patchOperand(i, readOperand(&codeList[i + 1]) + base);
+        break;
+      }
+      default: {
+        break;
+      }
+    }
+  }
+}
+
+auto CodeGenContext::appendRegisterFragment(Fragment& fragment)->void {
+  auto base = codeList.size();
+  auto constants = relocateConstants(fragment);
+  functionTable[fragment.name] = base;
+  codeList.insert(codeList.end(), fragment.codeList.begin(), fragment.codeList.end());
+  for (auto i = base; i < codeList.size(); i += 1 + getOperandCount(static_cast<RegisterInstruction>(codeList[i])) * sizeof(uint32_t)) {
+    auto operand = [&](size_t index) { return &codeList[i + 1 + index * sizeof(uint32_t)]; };
+    switch (static_cast<RegisterInstruction>(codeList[i])) {
+      case RegisterInstruction::Jump:
+      case RegisterInstruction::ConditionJump:
+      case RegisterInstruction::LogicalOr:
+      case RegisterInstruction::LogicalAnd: {
+        writeOperand(operand(0), readOperand(operand(0)) + base);
+        break;
+      }
+      case RegisterInstruction::SetGlobal: {
+        writeOperand(operand(0), constants[readOperand(operand(0))]);
+        break;
+      }
+      case RegisterInstruction::GetGlobal:
+      case RegisterInstruction::LoadConstant: {
+        writeOperand(operand(1), constants[readOperand(operand(1))]);
+        break;
+      }
+      default: {
+        break;
+      }
+    }
+  }
+}
+
+// 조각의 상수를 목적 코드의 상수 목록에 합치고 조각의 상수 번호별 새 번호를 돌려준다.
+auto CodeGenContext::relocateConstants(Fragment& fragment)->vector<size_t> {
+  vector<size_t> result;
+  for (auto& value: fragment.constantList) {
+    if (isNumber(value)) {
+      result.push_back(toConstant(toNumber(value)));
+      continue;
+    }
+    result.push_back(toConstant(toString(value)));
+    delete toObject(value);
+  }
+  return result;
+}
+
+auto CodeGenContext::getLocal(string name)->size_t {
   for (auto& symbolTable: symbolStack) {
     if (symbolTable.count(name))
       return symbolTable[name];
@@ -263,42 +722,143 @@ auto getLocal(string name)->size_t {
   return SIZE_MAX;
 }
 
-auto setLocal(string name)->void {
+auto CodeGenContext::setLocal(string name)->void {
   symbolStack.front()[name] = offsetStack.back();
   offsetStack.back() += 1;
   localSize = max(localSize, offsetStack.back());
 }
 
-auto initBlock()->void {
+auto CodeGenContext::initBlock()->void {
   localSize = 0;
   offsetStack.push_back(0);
   symbolStack.emplace_front();
 }
 
-auto pushBlock()->void {
+auto CodeGenContext::pushBlock()->void {
   symbolStack.emplace_front();
   offsetStack.push_back(offsetStack.back());
 }
 
-auto popBlock()->void {
+auto CodeGenContext::popBlock()->void {
   offsetStack.pop_back();
   symbolStack.pop_front();
 }
 
-auto writeCode(Instruction instruction)->size_t {
-  codeList.push_back({instruction});
-  return codeList.size() - 1;
+auto CodeGenContext::allocateRegister()->size_t {
+  return allocateRegisters(1);
 }
 
-auto writeCode(Instruction instruction, any operand)->size_t {
-  codeList.push_back({instruction, operand});
-  return codeList.size() - 1;
+auto CodeGenContext::allocateRegisters(size_t count)->size_t {
+  auto result = offsetStack.back();
+  offsetStack.back() += count;
+  localSize = max(localSize, offsetStack.back());
+  return result;
+}
+
+auto CodeGenContext::toRegister(Expression* expression, bool isAliasable)->size_t {
+  auto getVariable = dynamic_cast<GetVariable*>(expression);
+  if (getVariable && isAliasable && getLocal(getVariable->name) != SIZE_MAX)
+    return getLocal(getVariable->name);
+  auto setVariable = dynamic_cast<SetVariable*>(expression);
+  if (setVariable && isAliasable && getLocal(setVariable->name) != SIZE_MAX) {
+    setVariable->value->generateRegister(*this, getLocal(setVariable->name));
+    return getLocal(setVariable->name);
+  }
+  auto result = allocateRegister();
+  expression->generateRegister(*this, result);
+  return result;
+}
+
+auto isAssigning(Expression* expression)->bool {
+  if (dynamic_cast<SetVariable*>(expression))
+    return true;
+  if (auto node = dynamic_cast<Or*>(expression))
+    return isAssigning(node->lhs) || isAssigning(node->rhs);
+  if (auto node = dynamic_cast<And*>(expression))
+    return isAssigning(node->lhs) || isAssigning(node->rhs);
+  if (auto node = dynamic_cast<Relational*>(expression))
+    return isAssigning(node->lhs) || isAssigning(node->rhs);
+  if (auto node = dynamic_cast<Arithmetic*>(expression))
+    return isAssigning(node->lhs) || isAssigning(node->rhs);
+  if (auto node = dynamic_cast<Unary*>(expression))
+    return isAssigning(node->sub);
+  if (auto node = dynamic_cast<GetElement*>(expression))
+    return isAssigning(node->sub) || isAssigning(node->index);
+  if (auto node = dynamic_cast<SetElement*>(expression))
+    return isAssigning(node->sub) || isAssigning(node->index) || isAssigning(node->value);
+  if (auto node = dynamic_cast<Call*>(expression)) {
+    for (auto& argument: node->arguments) {
+      if (isAssigning(argument))
+        return true;
+    }
+    return isAssigning(node->sub);
+  }
+  if (auto node = dynamic_cast<ArrayLiteral*>(expression)) {
+    for (auto& value: node->values) {
+      if (isAssigning(value))
+        return true;
+    }
+  }
+  if (auto node = dynamic_cast<MapLiteral*>(expression)) {
+    for (auto& [key, value]: node->values) {
+      if (isAssigning(value))
+        return true;
+    }
+  }
+  return false;
+}
+
+auto CodeGenContext::writeCode(Instruction instruction)->size_t {
+  auto result = codeList.size();
+  codeList.push_back(static_cast<uint8_t>(instruction));
+  codeList.resize(codeList.size() + getOperandSize(instruction));
+  return result;
+}
+
+auto CodeGenContext::writeCode(Instruction instruction, size_t operand)->size_t {
+  auto result = writeCode(instruction);
+  writeOperand(&codeList[result + 1], operand);
+  return result;
+}
+
+auto CodeGenContext::writeCode(Instruction instruction, vector<size_t> operands)->size_t {
+  auto result = writeCode(instruction);
+  for (size_t i = 0; i < operands.size(); i++)
+    writeOperand(&codeList[result + 1 + i * sizeof(uint32_t)], operands[i]);
+  return result;
+}
+
+auto CodeGenContext::writeCode(RegisterInstruction instruction, vector<size_t> operands)->size_t {
+  auto result = codeList.size();
+  codeList.push_back(static_cast<uint8_t>(instruction));
+  codeList.resize(codeList.size() + getOperandCount(instruction) * sizeof(uint32_t));
+  for (size_t i = 0; i < operands.size(); i++)
+    writeOperand(&codeList[result + 1 + i * sizeof(uint32_t)], operands[i]);
+  return result;
+}
+
+auto CodeGenContext::toConstant(double value)->size_t {
+  if (numberTable.count(value) == 0) {
+    numberTable[value] = constantList.size();
+    constantList.push_back(value);
+  }
+  return numberTable[value];
+}
+
+auto CodeGenContext::toConstant(string value)->size_t {
+  if (stringTable.count(value) == 0) {
+    auto constant = new String();
+    constant->value = value;
+    stringTable[value] = constantList.size();
+    constantList.push_back(constant);
+  }
+  return stringTable[value];
 }
 
-auto patchAddress(size_t codeIndex)->void {
-  codeList[codeIndex].operand = codeList.size();
+auto CodeGenContext::patchAddress(size_t codeIndex)->void {
+  writeOperand(&codeList[codeIndex + 1], codeList.size());
 }
 
-auto patchOperand(size_t codeIndex, size_t operand)->void {
-  codeList[codeIndex].operand = operand;
+auto CodeGenContext::patchOperand(size_t codeIndex, size_t operand)->void {
+  writeOperand(&codeList[codeIndex + 1], operand);
 }
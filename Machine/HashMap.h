@@ -0,0 +1,226 @@
+﻿#pragma once
+#include <string>
+#include <vector>
+#include <utility>
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+
+using std::hash;
+using std::move;
+using std::string;
+using std::vector;
+using std::unordered_map;
+
+// 맵의 키 문자열은 스레드마다 한 벌만 두고 해시와 참조 수를 함께 둔다. 내용이 같은 키는
+// 주소도 같으므로 해시 테이블은 키를 포인터로 비교하고 해시를 다시 계산하지 않는다.
+// 키는 키 표의 노드 안에 있으므로 키 표가 커져도 주소가 바뀌지 않는다.
+struct Key {
+  const string* value;
+  size_t hash;
+  size_t count;
+};
+
+inline auto getKeyTable()->unordered_map<string, Key>& {
+  static thread_local unordered_map<string, Key> table;
+  return table;
+}
+
+// 한 번도 키로 쓰이지 않은 문자열이면 널을 돌려준다.
+inline auto findKey(const string& value)->Key* {
+  auto& table = getKeyTable();
+  auto iterator = table.find(value);
+  return iterator != table.end() ? &iterator->second : nullptr;
+}
+
+inline auto retainKey(Key* key)->Key* {
+  key->count++;
+  return key;
+}
+
+inline auto internKey(const string& value)->Key* {
+  auto result = getKeyTable().try_emplace(value);
+  auto& key = result.first->second;
+  if (result.second)
+    key = {&result.first->first, hash<string>()(value), 0};
+  return retainKey(&key);
+}
+
+inline auto releaseKey(Key* key)->void {
+  auto& table = getKeyTable();
+  if (--key->count == 0)
+    table.erase(table.find(*key->value));
+}
+
+// 문자열 키를 쓰는 개방 주소법 해시 테이블이다. 항목은 entries에 빽빽하게 두고
+// indices에는 항목 번호 + 1을 선형 탐사로 둔다. isOrdered가 참이면 지운 항목의 자리를
+// 비워 두어 넣은 순서를 지키고, 거짓이면 마지막 항목을 그 자리로 옮긴다.
+template<typename T>
+struct HashMap {
+  struct Entry {
+    Key* key;
+    T value;
+  };
+
+  vector<Entry> entries;
+  vector<uint32_t> indices;
+  size_t count = 0;
+  bool isOrdered = false;
+
+  HashMap(bool ordered = false): isOrdered(ordered) {}
+
+  HashMap(const HashMap& other): entries(other.entries), indices(other.indices), count(other.count), isOrdered(other.isOrdered) {
+    for (auto& entry: entries)
+      if (entry.key != nullptr)
+        retainKey(entry.key);
+  }
+
+  HashMap(HashMap&& other) noexcept: entries(move(other.entries)), indices(move(other.indices)), count(other.count), isOrdered(other.isOrdered) {
+    other.count = 0;
+  }
+
+  auto operator=(HashMap other)->HashMap& {
+    entries.swap(other.entries);
+    indices.swap(other.indices);
+    std::swap(count, other.count);
+    std::swap(isOrdered, other.isOrdered);
+    return *this;
+  }
+
+  ~HashMap() {
+    clear();
+  }
+
+  auto size() const->size_t {
+    return count;
+  }
+
+  auto find(Key* key)->T* {
+    if (count == 0)
+      return nullptr;
+    auto index = indices[locate(key)];
+    return index == 0 ? nullptr : &entries[index - 1].value;
+  }
+
+  auto find(const string& key)->T* {
+    auto interned = findKey(key);
+    return interned != nullptr ? find(interned) : nullptr;
+  }
+
+  auto operator[](Key* key)->T& {
+    if ((entries.size() + 1) * 4 > indices.size() * 3)
+      rehash(count * 2 + 8);
+    auto slot = locate(key);
+    if (indices[slot] == 0) {
+      entries.push_back({retainKey(key), T()});
+      indices[slot] = static_cast<uint32_t>(entries.size());
+      count++;
+    }
+    return entries[indices[slot] - 1].value;
+  }
+
+  auto operator[](const string& key)->T& {
+    auto interned = internKey(key);
+    auto& result = (*this)[interned];
+    releaseKey(interned);
+    return result;
+  }
+
+  auto erase(Key* key)->bool {
+    if (count == 0)
+      return false;
+    auto slot = locate(key);
+    auto index = indices[slot];
+    if (index == 0)
+      return false;
+    removeSlot(slot);
+    count--;
+    if (isOrdered) {
+      entries[index - 1].key = nullptr;
+      entries[index - 1].value = T();
+      releaseKey(key);
+      if (entries.size() > count * 2 + 8)
+        rehash(count * 2 + 8);
+      return true;
+    }
+    if (index != entries.size()) {
+      auto& last = entries.back();
+      indices[locate(last.key)] = index;
+      entries[index - 1] = move(last);
+    }
+    entries.pop_back();
+    releaseKey(key);
+    return true;
+  }
+
+  auto erase(const string& key)->bool {
+    auto interned = findKey(key);
+    return interned != nullptr && erase(interned);
+  }
+
+  auto clear()->void {
+    for (auto& entry: entries)
+      if (entry.key != nullptr)
+        releaseKey(entry.key);
+    entries.clear();
+    indices.clear();
+    count = 0;
+  }
+
+  template<typename Function>
+  auto forEach(Function function)->void {
+    for (auto& entry: entries)
+      if (entry.key != nullptr)
+        function(*entry.key->value, entry.value);
+  }
+
+  auto getMemorySize() const->size_t {
+    return entries.capacity() * sizeof(Entry) + indices.capacity() * sizeof(uint32_t);
+  }
+
+private:
+  // 키가 있으면 그 칸을, 없으면 키를 넣을 빈칸을 돌려준다.
+  auto locate(Key* key)->size_t {
+    auto mask = indices.size() - 1;
+    for (auto slot = key->hash & mask;; slot = (slot + 1) & mask) {
+      auto index = indices[slot];
+      if (index == 0 || entries[index - 1].key == key)
+        return slot;
+    }
+  }
+
+  // 선형 탐사의 사슬이 끊기지 않도록 뒤의 칸을 당겨 채운다.
+  auto removeSlot(size_t slot)->void {
+    auto mask = indices.size() - 1;
+    indices[slot] = 0;
+    for (auto next = (slot + 1) & mask; indices[next] != 0; next = (next + 1) & mask) {
+      auto home = entries[indices[next] - 1].key->hash & mask;
+      auto isBetween = slot <= next ? (slot < home && home <= next) : (slot < home || home <= next);
+      if (isBetween)
+        continue;
+      indices[slot] = indices[next];
+      indices[next] = 0;
+      slot = next;
+    }
+  }
+
+  auto rehash(size_t capacity)->void {
+    size_t size = 8;
+    while (size * 3 < capacity * 4)
+      size *= 2;
+    vector<Entry> live;
+    live.reserve(count);
+    for (auto& entry: entries)
+      if (entry.key != nullptr)
+        live.push_back(move(entry));
+    entries.swap(live);
+    indices.assign(size, 0);
+    auto mask = size - 1;
+    for (size_t i = 0; i < entries.size(); i++) {
+      auto slot = entries[i].key->hash & mask;
+      while (indices[slot] != 0)
+        slot = (slot + 1) & mask;
+      indices[slot] = static_cast<uint32_t>(i + 1);
+    }
+  }
+};
@@ -0,0 +1,610 @@
+﻿#include <map>
+#include <list>
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include "Main.h"
+
+using std::map;
+using std::max;
+using std::cout;
+using std::endl;
+using std::list;
+using std::vector;
+using std::function;
+
+extern map<string, function<Value(vector<Value>)>> builtinFunctionTable;
+
+// 호출 횟수나 반복 횟수가 이 값에 이른 함수가 생기면 가상 머신으로 넘어간다.
+static const size_t CallThreshold = 1000;
+static const size_t LoopThreshold = 10000;
+
+// 단계 0 인터프리터의 상태다. 지역 변수와 계산 중인 값은 가상 머신과 같은 값 스택에 두므로
+// 두 단계가 프레임을 그대로 주고받을 수 있고 가비지 컬렉터는 스택만 훑으면 된다.
+// 지역 변수의 칸 번호는 코드 생성기와 같은 규칙으로 정한다.
+struct InterpreterContext {
+  Isolate& isolate;
+  Program* program;
+  map<string, Function*> functionTable;
+  map<string, String*> stringTable;
+  list<map<string, size_t>> symbolStack;
+  vector<size_t> offsetStack;
+  size_t localSize = 0;
+  size_t loopDepth = 0;
+  Value* stack = nullptr;
+  Value* sp = nullptr;
+  Value* bp = nullptr;
+  Function* function = nullptr;
+  ObjectCode objectCode;
+  size_t exitAddress = 0;
+  bool isCompiled = false;
+
+  InterpreterContext(Isolate& isolate, Program* program): isolate(isolate), program(program) {}
+  ~InterpreterContext();
+
+  auto getLocal(string)->size_t;
+  auto setLocal(string)->void;
+  auto initBlock()->void;
+  auto pushBlock()->void;
+  auto popBlock()->void;
+  auto toConstant(string)->Value;
+  auto pushOperand(Value)->void;
+  auto popOperand()->Value;
+  auto call(Function*, size_t)->void;
+  auto callCompiled(size_t, size_t)->void;
+  auto enterLoop(For*)->bool;
+  auto compile()->void;
+  auto collectGarbage()->void;
+};
+
+static auto interpretBlock(InterpreterContext&, vector<Statement*>&)->Status;
+
+// 프로그램을 구문 트리에서 바로 실행하기 시작하고, 자주 호출되거나 오래 반복하는 함수가
+// 생기면 프로그램 전체의 코드를 한 번 생성해 그 뒤의 호출과 반복을 가상 머신에서 실행한다.
+auto executeTiered(Program* program, Isolate& isolate)->void {
+  isolate.global.clear();
+  isolate.globalTable.clear();
+  vector<Value> constantList;
+  isolate.initializeHeap(constantList);
+  isolate.valueStack.resize(Isolate::StackSize);
+  isolate.callStack.emplace_back();
+  InterpreterContext context(isolate, program);
+  for (auto& node: program->functions)
+    context.functionTable[node->name] = node;
+  for (auto& node: program->functions)
+    node->resolve(context);
+  context.stack = isolate.valueStack.data();
+  context.sp = context.stack;
+  context.bp = context.stack;
+  if (context.functionTable.count("main"))
+    context.call(context.functionTable["main"], 0);
+  isolate.callStack.pop_back();
+  isolate.printStatistics();
+}
+
+InterpreterContext::~InterpreterContext() {
+  for (auto& [value, constant]: stringTable)
+    delete constant;
+}
+
+auto Function::resolve(InterpreterContext& context)->void {
+  context.initBlock();
+  for (auto& name: parameters)
+    context.setLocal(name);
+  for (auto& node: block)
+    node->resolve(context);
+  context.popBlock();
+  localSize = context.localSize;
+}
+
+auto Variable::resolve(InterpreterContext& context)->void {
+  context.setLocal(name);
+  expression->resolve(context);
+  slot = context.getLocal(name);
+}
+
+auto Return::resolve(InterpreterContext& context)->void {
+  expression->resolve(context);
+}
+
+// 코드 생성기는 횟수 반복문의 검사를 본문 뒤에 두더라도 조건의 칸은 본문 앞에서 정하므로
+// 여기서도 조건을 본문보다 먼저 훑는다.
+auto For::resolve(InterpreterContext& context)->void {
+  context.loopDepth++;
+  context.pushBlock();
+  variable->resolve(context);
+  condition->resolve(context);
+  for (auto& node: block)
+    node->resolve(context);
+  expression->resolve(context);
+  context.popBlock();
+  context.loopDepth--;
+}
+
+auto Break::resolve(InterpreterContext& context)->void {
+  isInLoop = context.loopDepth > 0;
+}
+
+auto Continue::resolve(InterpreterContext& context)->void {
+  isInLoop = context.loopDepth > 0;
+}
+
+auto If::resolve(InterpreterContext& context)->void {
+  for (size_t i = 0; i < conditions.size(); i++) {
+    conditions[i]->resolve(context);
+    context.pushBlock();
+    for (auto& node: blocks[i])
+      node->resolve(context);
+    context.popBlock();
+  }
+  if (elseBlock.empty() == false) {
+    context.pushBlock();
+    for (auto& node: elseBlock)
+      node->resolve(context);
+    context.popBlock();
+  }
+}
+
+auto Print::resolve(InterpreterContext& context)->void {
+  for (auto i = arguments.size(); i > 0; i--)
+    arguments[i - 1]->resolve(context);
+}
+
+auto ExpressionStatement::resolve(InterpreterContext& context)->void {
+  expression->resolve(context);
+}
+
+auto Or::resolve(InterpreterContext& context)->void {
+  lhs->resolve(context);
+  rhs->resolve(context);
+}
+
+auto And::resolve(InterpreterContext& context)->void {
+  lhs->resolve(context);
+  rhs->resolve(context);
+}
+
+auto Relational::resolve(InterpreterContext& context)->void {
+  lhs->resolve(context);
+  rhs->resolve(context);
+}
+
+auto Arithmetic::resolve(InterpreterContext& context)->void {
+  lhs->resolve(context);
+  rhs->resolve(context);
+}
+
+auto Unary::resolve(InterpreterContext& context)->void {
+  sub->resolve(context);
+}
+
+auto Call::resolve(InterpreterContext& context)->void {
+  for (auto& node: arguments)
+    node->resolve(context);
+  sub->resolve(context);
+}
+
+auto GetElement::resolve(InterpreterContext& context)->void {
+  sub->resolve(context);
+  index->resolve(context);
+}
+
+auto SetElement::resolve(InterpreterContext& context)->void {
+  value->resolve(context);
+  sub->resolve(context);
+  index->resolve(context);
+}
+
+// 지역 변수가 아니면 가상 머신의 링커와 같이 함수, 내장 함수, 전역 변수의 순서로 찾는다.
+auto GetVariable::resolve(InterpreterContext& context)->void {
+  slot = context.getLocal(name);
+  if (slot != SIZE_MAX)
+    return;
+  if (context.functionTable.count(name))
+    function = context.functionTable[name];
+  else if (builtinFunctionTable.count(name))
+    builtin = &builtinFunctionTable.at(name);
+  else
+    globalSlot = context.isolate.resolveGlobal(name);
+}
+
+auto SetVariable::resolve(InterpreterContext& context)->void {
+  value->resolve(context);
+  slot = context.getLocal(name);
+  if (slot == SIZE_MAX)
+    globalSlot = context.isolate.resolveGlobal(name);
+}
+
+auto NullLiteral::resolve(InterpreterContext&)->void {
+}
+
+auto BooleanLiteral::resolve(InterpreterContext&)->void {
+}
+
+auto NumberLiteral::resolve(InterpreterContext&)->void {
+}
+
+auto StringLiteral::resolve(InterpreterContext& context)->void {
+  constant = context.toConstant(value);
+}
+
+auto ArrayLiteral::resolve(InterpreterContext& context)->void {
+  for (auto i = values.size(); i > 0; i--)
+    values[i - 1]->resolve(context);
+}
+
+auto MapLiteral::resolve(InterpreterContext& context)->void {
+  keys.clear();
+  for (auto& [key, value]: values) {
+    keys.push_back(context.toConstant(key));
+    value->resolve(context);
+  }
+}
+
+auto Function::interpret(InterpreterContext& context)->Status {
+  return interpretBlock(context, block);
+}
+
+auto Variable::interpret(InterpreterContext& context)->Status {
+  expression->interpret(context);
+  context.bp[slot] = context.popOperand();
+  return Status::Normal;
+}
+
+auto Return::interpret(InterpreterContext& context)->Status {
+  expression->interpret(context);
+  return Status::Return;
+}
+
+// 증가식을 계산한 다음이 되돌아가는 자리이며, 이때 가상 머신의 코드가 있으면 반복문의
+// 검사 코드로 넘어가 함수의 나머지를 가상 머신에서 실행한다.
+auto For::interpret(InterpreterContext& context)->Status {
+  variable->interpret(context);
+  while (true) {
+    condition->interpret(context);
+    if (isTrue(context.popOperand()) == false)
+      break;
+    auto status = interpretBlock(context, block);
+    if (status == Status::Return)
+      return status;
+    if (status == Status::Break)
+      break;
+    expression->interpret(context);
+    context.popOperand();
+    if (context.enterLoop(this))
+      return Status::Return;
+    context.collectGarbage();
+  }
+  return Status::Normal;
+}
+
+auto Break::interpret(InterpreterContext&)->Status {
+  return isInLoop ? Status::Break : Status::Normal;
+}
+
+auto Continue::interpret(InterpreterContext&)->Status {
+  return isInLoop ? Status::Continue : Status::Normal;
+}
+
+auto If::interpret(InterpreterContext& context)->Status {
+  for (size_t i = 0; i < conditions.size(); i++) {
+    conditions[i]->interpret(context);
+    if (isTrue(context.popOperand()))
+      return interpretBlock(context, blocks[i]);
+  }
+  return interpretBlock(context, elseBlock);
+}
+
+auto Print::interpret(InterpreterContext& context)->Status {
+  for (auto i = arguments.size(); i > 0; i--)
+    arguments[i - 1]->interpret(context);
+  for (size_t i = 0; i < arguments.size(); i++) {
+    auto value = context.popOperand();
+    cout << value;
+  }
+  if (lineFeed)
+    cout << endl;
+  return Status::Normal;
+}
+
+auto ExpressionStatement::interpret(InterpreterContext& context)->Status {
+  expression->interpret(context);
+  context.popOperand();
+  return Status::Normal;
+}
+
+auto Or::interpret(InterpreterContext& context)->void {
+  lhs->interpret(context);
+  if (isTrue(context.sp[-1]))
+    return;
+  context.popOperand();
+  rhs->interpret(context);
+}
+
+auto And::interpret(InterpreterContext& context)->void {
+  lhs->interpret(context);
+  if (isFalse(context.sp[-1]))
+    return;
+  context.popOperand();
+  rhs->interpret(context);
+}
+
+auto Relational::interpret(InterpreterContext& context)->void {
+  lhs->interpret(context);
+  rhs->interpret(context);
+  auto rValue = context.popOperand();
+  auto lValue = context.popOperand();
+  switch (kind) {
+  case Kind::Equal:          context.pushOperand(equal(lValue, rValue)); break;
+  case Kind::NotEqual:       context.pushOperand(notEqual(lValue, rValue)); break;
+  case Kind::LessThan:       context.pushOperand(lessThan(lValue, rValue)); break;
+  case Kind::GreaterThan:    context.pushOperand(greaterThan(lValue, rValue)); break;
+  case Kind::LessOrEqual:    context.pushOperand(lessOrEqual(lValue, rValue)); break;
+  case Kind::GreaterOrEqual: context.pushOperand(greaterOrEqual(lValue, rValue)); break;
+  default: context.pushOperand(nullptr); break;
+  }
+}
+
+auto Arithmetic::interpret(InterpreterContext& context)->void {
+  lhs->interpret(context);
+  rhs->interpret(context);
+  auto rValue = context.popOperand();
+  auto lValue = context.popOperand();
+  switch (kind) {
+  case Kind::Add:      context.pushOperand(context.isolate.add(lValue, rValue)); break;
+  case Kind::Subtract: context.pushOperand(subtract(lValue, rValue)); break;
+  case Kind::Multiply: context.pushOperand(multiply(lValue, rValue)); break;
+  case Kind::Divide:   context.pushOperand(divide(lValue, rValue)); break;
+  case Kind::Modulo:   context.pushOperand(modulo(lValue, rValue)); break;
+  default: context.pushOperand(nullptr); break;
+  }
+}
+
+auto Unary::interpret(InterpreterContext& context)->void {
+  sub->interpret(context);
+  auto value = context.popOperand();
+  switch (kind) {
+  case Kind::Add:      context.pushOperand(absolute(value)); break;
+  case Kind::Subtract: context.pushOperand(reverseSign(value)); break;
+  default: context.pushOperand(nullptr); break;
+  }
+}
+
+// 이름으로 부르는 함수는 함수 값을 만들지 않고 바로 부른다. 함수 값은 가상 머신의
+// 코드 주소이므로 가상 머신에서 실행한다.
+auto Call::interpret(InterpreterContext& context)->void {
+  for (auto& node: arguments)
+    node->interpret(context);
+  auto getVariable = dynamic_cast<GetVariable*>(sub);
+  if (getVariable != nullptr && getVariable->function != nullptr) {
+    context.call(getVariable->function, arguments.size());
+    return;
+  }
+  sub->interpret(context);
+  auto callee = context.popOperand();
+  if (isSize(callee)) {
+    context.callCompiled(toSize(callee), arguments.size());
+    return;
+  }
+  if (isBuiltinFunction(callee)) {
+    vector<Value> values(context.sp - arguments.size(), context.sp);
+    context.sp -= arguments.size();
+    context.pushOperand(toBuiltinFunction(callee)(values));
+    return;
+  }
+  context.sp -= arguments.size();
+  context.pushOperand(nullptr);
+}
+
+auto GetElement::interpret(InterpreterContext& context)->void {
+  sub->interpret(context);
+  index->interpret(context);
+  auto indexValue = context.popOperand();
+  auto subValue = context.popOperand();
+  context.pushOperand(getElement(subValue, indexValue));
+}
+
+auto SetElement::interpret(InterpreterContext& context)->void {
+  value->interpret(context);
+  sub->interpret(context);
+  index->interpret(context);
+  auto indexValue = context.popOperand();
+  auto subValue = context.popOperand();
+  setElement(subValue, indexValue, context.sp[-1]);
+}
+
+auto GetVariable::interpret(InterpreterContext& context)->void {
+  if (slot != SIZE_MAX)
+    context.pushOperand(context.bp[slot]);
+  else if (function != nullptr) {
+    context.compile();
+    context.pushOperand(function->address);
+  }
+  else if (globalSlot != SIZE_MAX)
+    context.pushOperand(context.isolate.global[globalSlot]);
+  else
+    context.pushOperand(builtin);
+}
+
+auto SetVariable::interpret(InterpreterContext& context)->void {
+  value->interpret(context);
+  if (slot != SIZE_MAX)
+    context.bp[slot] = context.sp[-1];
+  else
+    context.isolate.global[globalSlot] = context.sp[-1];
+}
+
+auto NullLiteral::interpret(InterpreterContext& context)->void {
+  context.pushOperand(nullptr);
+}
+
+auto BooleanLiteral::interpret(InterpreterContext& context)->void {
+  context.pushOperand(value);
+}
+
+auto NumberLiteral::interpret(InterpreterContext& context)->void {
+  context.pushOperand(value);
+}
+
+auto StringLiteral::interpret(InterpreterContext& context)->void {
+  context.pushOperand(constant);
+}
+
+auto ArrayLiteral::interpret(InterpreterContext& context)->void {
+  for (auto i = values.size(); i > 0; i--)
+    values[i - 1]->interpret(context);
+  auto result = new Array();
+  for (size_t i = 0; i < values.size(); i++)
+    result->values.push_back(context.popOperand());
+  context.pushOperand(result);
+  context.isolate.newObject(result);
+}
+
+auto MapLiteral::interpret(InterpreterContext& context)->void {
+  size_t i = 0;
+  for (auto& [key, value]: values) {
+    context.pushOperand(keys[i++]);
+    value->interpret(context);
+  }
+  auto result = new Map();
+  result->shape = &context.isolate.emptyShape;
+  for (size_t i = 0; i < values.size(); i++) {
+    auto value = context.popOperand();
+    auto key = context.popOperand();
+    setValueOfMap(result, key, value);
+  }
+  context.pushOperand(result);
+  context.isolate.newObject(result);
+}
+
+// 인자는 스택 꼭대기에 있고 프레임은 가상 머신의 Alloca와 같이 null로 채운다.
+// 반환 값은 인자가 있던 자리에 남는다.
+auto InterpreterContext::call(Function* node, size_t count)->void {
+  if (isCompiled == false && ++node->callCount >= CallThreshold)
+    compile();
+  if (isCompiled) {
+    callCompiled(node->address, count);
+    return;
+  }
+  auto caller = function;
+  auto callerBase = bp;
+  function = node;
+  bp = sp - count;
+  while (sp < bp + node->localSize)
+    pushOperand(nullptr);
+  sp = bp + node->localSize;
+  if (node->interpret(*this) != Status::Return)
+    pushOperand(nullptr);
+  auto result = popOperand();
+  sp = bp;
+  bp = callerBase;
+  function = caller;
+  pushOperand(result);
+  collectGarbage();
+}
+
+// 돌아올 프레임으로 Exit 명령을 가리키는 프레임을 먼저 쌓으면 가상 머신의 Return이
+// 그 명령으로 가서 실행을 마친다.
+auto InterpreterContext::callCompiled(size_t address, size_t count)->void {
+  auto& callStack = isolate.callStack;
+  callStack.push_back({exitAddress, static_cast<size_t>(bp - stack)});
+  callStack.push_back({0, static_cast<size_t>(sp - count - stack)});
+  sp = stack + isolate.run(objectCode, address, sp - stack);
+}
+
+// 반복문이 되돌아갈 때마다 불린다. 가상 머신으로 넘어가 함수를 끝까지 실행했으면 참이며
+// 반환 값은 프레임의 첫 칸에 있다.
+auto InterpreterContext::enterLoop(For* node)->bool {
+  if (isCompiled == false && ++function->loopCount >= LoopThreshold)
+    compile();
+  if (isCompiled == false)
+    return false;
+  auto& callStack = isolate.callStack;
+  callStack.push_back({exitAddress, static_cast<size_t>(bp - stack)});
+  callStack.push_back({0, static_cast<size_t>(bp - stack)});
+  sp = stack + isolate.run(objectCode, node->address, sp - stack);
+  return true;
+}
+
+// 프로그램 전체의 코드를 생성해 연결한다. 단계 0이 이미 만든 객체가 힙에 있으므로
+// 힙을 비우지 않고 상수만 오래된 객체로 표시한다.
+auto InterpreterContext::compile()->void {
+  if (isCompiled)
+    return;
+  objectCode = generate(program);
+  isolate.markConstants(objectCode.constantList);
+  isolate.link(objectCode);
+  for (auto& node: program->functions)
+    node->address = objectCode.functionTable[node->name];
+  auto& codeList = objectCode.codeList;
+  exitAddress = 0;
+  while (static_cast<Instruction>(codeList[exitAddress]) != Instruction::Exit)
+    exitAddress += 1 + getOperandSize(static_cast<Instruction>(codeList[exitAddress]));
+  isCompiled = true;
+}
+
+auto InterpreterContext::collectGarbage()->void {
+  if (isolate.allocatedSize >= isolate.options.nurserySize)
+    isolate.collectGarbage(sp);
+}
+
+auto InterpreterContext::getLocal(string name)->size_t {
+  for (auto& symbolTable: symbolStack) {
+    if (symbolTable.count(name))
+      return symbolTable[name];
+  }
+  return SIZE_MAX;
+}
+
+auto InterpreterContext::setLocal(string name)->void {
+  symbolStack.front()[name] = offsetStack.back();
+  offsetStack.back() += 1;
+  localSize = max(localSize, offsetStack.back());
+}
+
+auto InterpreterContext::initBlock()->void {
+  localSize = 0;
+  offsetStack.push_back(0);
+  symbolStack.emplace_front();
+}
+
+auto InterpreterContext::pushBlock()->void {
+  symbolStack.emplace_front();
+  offsetStack.push_back(offsetStack.back());
+}
+
+auto InterpreterContext::popBlock()->void {
+  offsetStack.pop_back();
+  symbolStack.pop_front();
+}
+
+auto InterpreterContext::toConstant(string value)->Value {
+  if (stringTable.count(value) == 0) {
+    auto constant = new String();
+    constant->value = value;
+    constant->isOld = true;
+    stringTable[value] = constant;
+  }
+  return stringTable[value];
+}
+
+auto InterpreterContext::pushOperand(Value value)->void {
+  if (sp == stack + Isolate::StackSize) {
+    cout << "스택이 넘쳤습니다.";
+    exit(1);
+  }
+  *sp++ = value;
+}
+
+auto InterpreterContext::popOperand()->Value {
+  return *--sp;
+}
+
+auto interpretBlock(InterpreterContext& context, vector<Statement*>& block)->Status {
+  for (auto& node: block) {
+    auto status = node->interpret(context);
+    if (status != Status::Normal)
+      return status;
+  }
+  return Status::Normal;
+}
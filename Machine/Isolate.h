@@ -0,0 +1,77 @@
+﻿#pragma once
+#include <map>
+#include <vector>
+#include <string>
+#include "Datatype.h"
+#include "Code.h"
+
+using std::map;
+using std::vector;
+using std::string;
+
+struct StackFrame {
+  size_t instructionPointer = 0;
+  size_t basePointer = 0;
+  size_t stackPointer = 0;
+  size_t resultRegister = 0;
+};
+
+// GetField, SetField 명령마다 하나씩 두는 캐시로, 마지막으로 본 맵의 모양과
+// 그 모양에서 키가 놓인 슬롯을 기억한다.
+struct InlineCache {
+  Shape* shape = nullptr;
+  size_t slot = 0;
+};
+
+struct GarbageCollectorStatistics {
+  size_t minorCount = 0;
+  size_t majorCount = 0;
+  double totalPause = 0;
+  double maxPause = 0;
+};
+
+// 가상 머신 하나의 힙, 전역 변수, 스택을 모두 소유한다.
+// Isolate끼리는 상태를 공유하지 않으므로 스레드마다 하나씩 만들어 동시에 실행할 수 있다.
+// 목적 코드의 상수 객체도 실행 중에 표시되므로 목적 코드는 Isolate마다 따로 생성해야 한다.
+struct Isolate {
+  static const size_t StackSize = 1 << 20;
+
+  GarbageCollectorOptions options;
+  GarbageCollectorStatistics statistics;
+  vector<Value> youngObjects;
+  vector<Value> oldObjects;
+  vector<Value> rememberedSet;
+  size_t allocatedSize = 0;
+  size_t oldSize = 0;
+  size_t majorThreshold = 0;
+  vector<Value> global;
+  map<string, size_t> globalTable;
+  vector<Value> valueStack;
+  vector<StackFrame> callStack;
+  Shape emptyShape;
+  vector<InlineCache> inlineCaches;
+
+  Isolate(GarbageCollectorOptions = {});
+  Isolate(const Isolate&) = delete;
+  auto operator=(const Isolate&)->Isolate& = delete;
+  ~Isolate();
+
+  auto execute(ObjectCode)->void;
+  auto executeRegister(ObjectCode)->void;
+  auto run(ObjectCode&, size_t, size_t)->size_t;
+
+  auto link(ObjectCode&)->void;
+  auto linkRegister(ObjectCode&)->void;
+  auto resolveGlobal(string&)->size_t;
+  auto getGlobal(map<string, size_t>&, string&)->Value;
+  auto add(Value, Value)->Value;
+  auto newString(string)->String*;
+  auto newObject(Value)->void;
+  auto initializeHeap(vector<Value>&)->void;
+  auto markConstants(vector<Value>&)->void;
+  auto releaseHeap()->void;
+  auto collectGarbage(Value*)->void;
+  auto sweepYoung()->void;
+  auto sweepOld()->void;
+  auto printStatistics()->void;
+};
@@ -1,405 +1,1045 @@
-﻿#include <any>
-#include <map>
-#include <list>
+﻿#include <map>
+#include <chrono>
 #include <vector>
+#include <algorithm>
 #include <functional>
 #include "Datatype.h"
 #include "Code.h"
+#include "Isolate.h"
 #include <cmath>
 
-using std::get;
-using std::any;
+#if (defined(__GNUC__) || defined(__clang__)) && !defined(DISABLE_COMPUTED_GOTO)
+#define USE_COMPUTED_GOTO
+#define CASE(type, name) Label##type##name:
+#define DISPATCH() goto *dispatchTable[*ip++]
+#else
+#define CASE(type, name) case type::name:
+#define DISPATCH() continue
+#endif
+
 using std::map;
 using std::cout;
 using std::endl;
-using std::list;
-using std::tuple;
+using std::max;
 using std::vector;
 using std::function;
+using std::chrono::steady_clock;
+using std::chrono::duration;
 
-struct StackFrame {
-  vector<any> variables;
-  vector<any> operandStack;
-  size_t instructionPointer = 0;
-};
-static list<Object*> objects;
-static map<string, any> global;
-static vector<StackFrame> callStack;
-extern map<string, function<any(vector<any>)>> builtinFunctionTable;
+extern map<string, function<Value(vector<Value>)>> builtinFunctionTable;
+thread_local vector<Value>* currentRememberedSet = nullptr;
 
-static auto pushOperand(any value)->void;
-static auto peekOperand()->any;
-static auto popOperand()->any;
-static auto collectGarbage()->void;
-static auto markObject(any)->void;
-static auto sweepObject()->void;
+static auto resolveFunction(ObjectCode&, map<string, size_t>&, string&)->size_t;
+static auto fetchOperand(uint8_t*&)->size_t;
+static auto callBuiltin(Value, Value*, size_t)->Value;
+static auto getField(Value, Value, InlineCache&)->Value;
+static auto setField(Value, Value, Value, InlineCache&)->void;
+static auto sizeOfObject(Value)->size_t;
+static auto markObject(Value, bool)->void;
+static auto markChildren(Value, bool)->void;
 
-auto execute(tuple<vector<Code>, map<string, size_t>> objectCode)->void {
+auto Isolate::execute(ObjectCode objectCode)->void {
   global.clear();
-  objects.clear();
+  globalTable.clear();
+  initializeHeap(objectCode.constantList);
+  link(objectCode);
+  valueStack.resize(StackSize);
   callStack.emplace_back();
-  auto codeList = get<0>(objectCode);
-  auto functionTable = get<1>(objectCode);
-  while (true) {
-    auto code = codeList[callStack.back().instructionPointer];
-    switch (code.instruction) {
-    case Instruction::Exit: {
-      callStack.pop_back();
-      return;
-    }
-    case Instruction::Call: {
-      auto operand = popOperand();
-      if (isSize(operand)) {
-        StackFrame stackFrame;
-        stackFrame.instructionPointer = toSize(operand);
-        for (size_t i = 0; i < toSize(code.operand); i++) {
-          stackFrame.variables.push_back(callStack.back().operandStack.back());
-          callStack.back().operandStack.pop_back();
-        }
-        callStack.push_back(stackFrame);
-        continue;
-      }
-      if (isBuiltinFunction(operand)) {
-        vector<any> arguments;
-        for (size_t i = 0; i < toSize(code.operand); i++)
-          arguments.push_back(popOperand());
-        pushOperand(toBuiltinFunction(operand)(arguments));
-        break;
-      }
-      pushOperand(nullptr);
-      break;
-    }
-    case Instruction::Alloca: {
-      auto localSize = toSize(code.operand);
-      callStack.back().variables.resize(localSize);
-      break;
-    }
-    case Instruction::Return: {
-      any result = nullptr;
-      if (callStack.back().operandStack.empty() == false)
-        result = callStack.back().operandStack.back();
-      callStack.pop_back();
-      callStack.back().operandStack.push_back(result);
-      collectGarbage();
-      break;
-    }
-    case Instruction::Jump: {
-      callStack.back().instructionPointer = toSize(code.operand);
-      continue;
-    }
-    case Instruction::ConditionJump: {
-      auto condition = popOperand();
-      if (isTrue(condition))
-        break;
-      callStack.back().instructionPointer = toSize(code.operand);
-      continue;
+  run(objectCode, 0, 0);
+  printStatistics();
+}
+
+// 연결을 마친 목적 코드를 address부터 실행한다. bp는 호출 스택의 마지막 프레임을 따르며
+// Exit를 만나면 그 프레임을 꺼내고 스택의 높이를 돌려준다.
+auto Isolate::run(ObjectCode& objectCode, size_t address, size_t stackPointer)->size_t {
+  auto& constantList = objectCode.constantList;
+  auto& functionTable = objectCode.functionTable;
+  auto code = objectCode.codeList.data();
+  auto ip = code + address;
+  auto stack = valueStack.data();
+  auto sp = stack + stackPointer;
+  auto bp = stack + callStack.back().basePointer;
+  auto pushOperand = [&](Value value) {
+    if (sp == stack + StackSize) {
+      cout << "스택이 넘쳤습니다.";
+      exit(1);
     }
-    case Instruction::Print: {
-      for (size_t i = 0; i < toSize(code.operand); i++) {
-        auto value = popOperand();
-        cout << value;
-      }
-      break;
+    *sp++ = value;
+  };
+  auto peekOperand = [&]()->Value {
+    return sp[-1];
+  };
+  auto popOperand = [&]()->Value {
+    return *--sp;
+  };
+#ifdef USE_COMPUTED_GOTO
+  static void* dispatchTable[] = {
+    &&LabelInstructionExit,
+    &&LabelInstructionCall, &&LabelInstructionAlloca, &&LabelInstructionReturn,
+    &&LabelInstructionJump, &&LabelInstructionConditionJump,
+    &&LabelInstructionPrint, &&LabelInstructionPrintLine,
+    &&LabelInstructionLogicalOr, &&LabelInstructionLogicalAnd,
+    &&LabelInstructionAdd, &&LabelInstructionSubtract,
+    &&LabelInstructionMultiply, &&LabelInstructionDivide, &&LabelInstructionModulo,
+    &&LabelInstructionEqual, &&LabelInstructionNotEqual,
+    &&LabelInstructionLessThan, &&LabelInstructionGreaterThan,
+    &&LabelInstructionLessOrEqual, &&LabelInstructionGreaterOrEqual,
+    &&LabelInstructionAbsolute, &&LabelInstructionReverseSign,
+    &&LabelInstructionGetElement, &&LabelInstructionSetElement,
+    &&LabelInstructionGetGlobal, &&LabelInstructionSetGlobal,
+    &&LabelInstructionGetGlobalSlot, &&LabelInstructionSetGlobalSlot,
+    &&LabelInstructionGetLocal, &&LabelInstructionSetLocal,
+    &&LabelInstructionPushNull, &&LabelInstructionPushBoolean,
+    &&LabelInstructionPushNumber, &&LabelInstructionPushString,
+    &&LabelInstructionPushFunction,
+    &&LabelInstructionPushArray, &&LabelInstructionPushMap,
+    &&LabelInstructionPopOperand,
+    &&LabelInstructionSetLocalPop, &&LabelInstructionIncLocal, &&LabelInstructionAddNumber,
+    &&LabelInstructionEqualJump, &&LabelInstructionNotEqualJump,
+    &&LabelInstructionLessThanJump, &&LabelInstructionGreaterThanJump,
+    &&LabelInstructionLessOrEqualJump, &&LabelInstructionGreaterOrEqualJump,
+    &&LabelInstructionLessThanLocalConstantJump, &&LabelInstructionLessThanLocalLocalJump,
+    &&LabelInstructionGetField, &&LabelInstructionSetField,
+  };
+  DISPATCH();
+#else
+  while (true) {
+    switch (static_cast<Instruction>(*ip++)) {
+#endif
+  CASE(Instruction, Exit) {
+    callStack.pop_back();
+    return sp - stack;
+  }
+  CASE(Instruction, Call) {
+    auto operand = fetchOperand(ip);
+    auto callee = popOperand();
+    if (isSize(callee)) {
+      bp = sp - operand;
+      callStack.back().instructionPointer = ip - code;
+      callStack.push_back({0, static_cast<size_t>(bp - stack)});
+      ip = code + toSize(callee);
+      DISPATCH();
     }
-    case Instruction::PrintLine: {
-      cout << endl;
-      break;
+    if (isBuiltinFunction(callee)) {
+      sp -= operand;
+      pushOperand(callBuiltin(callee, sp, operand));
+      DISPATCH();
     }
-    case Instruction::LogicalOr: {
-      auto value = popOperand();
-      if (isTrue(value)) {
-        pushOperand(value);
-        callStack.back().instructionPointer = toSize(code.operand);
-        continue;
-      }
-      break;
-    }
-    case Instruction::LogicalAnd: {
+    sp -= operand;
+    pushOperand(nullptr);
+    DISPATCH();
+  }
+  CASE(Instruction, Alloca) {
+    auto operand = fetchOperand(ip);
+    while (sp < bp + operand)
+      pushOperand(nullptr);
+    sp = bp + operand;
+    DISPATCH();
+  }
+  CASE(Instruction, Return) {
+    auto result = popOperand();
+    sp = bp;
+    callStack.pop_back();
+    bp = stack + callStack.back().basePointer;
+    ip = code + callStack.back().instructionPointer;
+    pushOperand(result);
+    if (allocatedSize >= options.nurserySize)
+      collectGarbage(sp);
+    DISPATCH();
+  }
+  CASE(Instruction, Jump) {
+    auto operand = fetchOperand(ip);
+    ip = code + operand;
+    if (allocatedSize >= options.nurserySize)
+      collectGarbage(sp);
+    DISPATCH();
+  }
+  CASE(Instruction, ConditionJump) {
+    auto operand = fetchOperand(ip);
+    auto condition = popOperand();
+    if (isTrue(condition))
+      DISPATCH();
+    ip = code + operand;
+    DISPATCH();
+  }
+  CASE(Instruction, Print) {
+    auto operand = fetchOperand(ip);
+    for (size_t i = 0; i < operand; i++) {
       auto value = popOperand();
-      if (isFalse(value)) {
-        pushOperand(value);
-        callStack.back().instructionPointer = toSize(code.operand);
-        continue;
-      }
-      break;
-    }
-    case Instruction::Equal: {
-      auto rValue = popOperand();
-      auto lValue = popOperand();
-      if (isNull(lValue) && isNull(rValue))
-        pushOperand(true);
-      else if (isBoolean(lValue) && isBoolean(rValue))
-        pushOperand(toBoolean(lValue) == toBoolean(rValue));
-      else if (isNumber(lValue) && isNumber(rValue))
-        pushOperand(toNumber(lValue) == toNumber(rValue));
-      else if (isString(lValue) && isString(rValue))
-        pushOperand(toString(lValue) == toString(rValue));
-      else
-        pushOperand(false);
-      break;
-    }
-    case Instruction::NotEqual: {
-      auto rValue = popOperand();
-      auto lValue = popOperand();
-      if (isNull(lValue) && isNull(rValue))
-        pushOperand(false);
-      else if (isNull(lValue) || isNull(rValue))
-        pushOperand(true);
-      if (isBoolean(lValue) && isBoolean(rValue))
-        pushOperand(toBoolean(lValue) != toBoolean(rValue));
-      else if (isNumber(lValue) && isNumber(rValue))
-        pushOperand(toNumber(lValue) != toNumber(rValue));
-      else if (isString(lValue) && isString(rValue))
-        pushOperand(toString(lValue) != toString(rValue));
-      else
-        pushOperand(false);
-      break;
-    }
-    case Instruction::LessThan: {
-      auto rValue = popOperand();
-      auto lValue = popOperand();
-      if (isNumber(lValue) && isNumber(rValue))
-        pushOperand(toNumber(lValue) < toNumber(rValue));
-      else
-        pushOperand(false);
-      break;
-    }
-    case Instruction::GreaterThan: {
-      auto rValue = popOperand();
-      auto lValue = popOperand();
-      if (isNumber(lValue) && isNumber(rValue))
-        pushOperand(toNumber(lValue) > toNumber(rValue));
-      else
-        pushOperand(false);
-      break;
-    }
-    case Instruction::LessOrEqual: {
-      auto rValue = popOperand();
-      auto lValue = popOperand();
-      if (isNumber(lValue) && isNumber(rValue))
-        pushOperand(toNumber(lValue) <= toNumber(rValue));
-      else
-        pushOperand(false);
-      break;
-    }
-    case Instruction::GreaterOrEqual: {
-      auto rValue = popOperand();
-      auto lValue = popOperand();
-      if (isNumber(lValue) && isNumber(rValue))
-        pushOperand(toNumber(lValue) >= toNumber(rValue));
-      else
-        pushOperand(false);
-      break;
-    }
-    case Instruction::Add: {
-      auto rValue = popOperand();
-      auto lValue = popOperand();
-      if (isNumber(lValue) && isNumber(rValue))
-        pushOperand(toNumber(lValue) + toNumber(rValue));
-      else if (isString(lValue) && isString(rValue))
-        pushOperand(toString(lValue) + toString(rValue));
-      else
-        pushOperand(0.0);
-      break;
+      cout << value;
     }
-    case Instruction::Subtract: {
-      auto rValue = popOperand();
-      auto lValue = popOperand();
-      if (isNumber(lValue) && isNumber(rValue))
-        pushOperand(toNumber(lValue) - toNumber(rValue));
-      else
-        pushOperand(0.0);
-      break;
-    }
-    case Instruction::Multiply: {
-      auto rValue = popOperand();
-      auto lValue = popOperand();
-      if (isNumber(lValue) && isNumber(rValue))
-        pushOperand(toNumber(lValue) * toNumber(rValue));
-      else
-        pushOperand(0.0);
-      break;
-    }
-    case Instruction::Divide: {
-      auto rValue = popOperand();
-      auto lValue = popOperand();
-      if (isNumber(lValue) && isNumber(rValue) && toNumber(rValue) == 0)
-        pushOperand(0.0);
-      else if (isNumber(lValue) && isNumber(rValue))
-        pushOperand(toNumber(lValue) / toNumber(rValue));
-      else
-        pushOperand(0.0);
-      break;
-    }
-    case Instruction::Modulo: {
-      auto rValue = popOperand();
-      auto lValue = popOperand();
-      if (isNumber(lValue) && isNumber(rValue) && toNumber(rValue) == 0)
-        pushOperand(0.0);
-      else if (isNumber(lValue) && isNumber(rValue))
-        pushOperand(fmod(toNumber(lValue), toNumber(rValue)));
-      else
-        pushOperand(0.0);
-      break;
+    DISPATCH();
+  }
+  CASE(Instruction, PrintLine) {
+    cout << endl;
+    DISPATCH();
+  }
+  CASE(Instruction, LogicalOr) {
+    auto operand = fetchOperand(ip);
+    auto value = popOperand();
+    if (isTrue(value)) {
+      pushOperand(value);
+      ip = code + operand;
+      DISPATCH();
     }
-    case Instruction::Absolute: {
-      auto value = popOperand();
-      if (isNumber(value))
-        pushOperand(abs(toNumber(value)));
-      else
-        pushOperand(0.0);
-      break;
+    DISPATCH();
+  }
+  CASE(Instruction, LogicalAnd) {
+    auto operand = fetchOperand(ip);
+    auto value = popOperand();
+    if (isFalse(value)) {
+      pushOperand(value);
+      ip = code + operand;
+      DISPATCH();
     }
-    case Instruction::ReverseSign: {
+    DISPATCH();
+  }
+  CASE(Instruction, Equal) {
+    auto rValue = popOperand();
+    auto lValue = popOperand();
+    pushOperand(equal(lValue, rValue));
+    DISPATCH();
+  }
+  CASE(Instruction, NotEqual) {
+    auto rValue = popOperand();
+    auto lValue = popOperand();
+    pushOperand(notEqual(lValue, rValue));
+    DISPATCH();
+  }
+  CASE(Instruction, LessThan) {
+    auto rValue = popOperand();
+    auto lValue = popOperand();
+    pushOperand(lessThan(lValue, rValue));
+    DISPATCH();
+  }
+  CASE(Instruction, GreaterThan) {
+    auto rValue = popOperand();
+    auto lValue = popOperand();
+    pushOperand(greaterThan(lValue, rValue));
+    DISPATCH();
+  }
+  CASE(Instruction, LessOrEqual) {
+    auto rValue = popOperand();
+    auto lValue = popOperand();
+    pushOperand(lessOrEqual(lValue, rValue));
+    DISPATCH();
+  }
+  CASE(Instruction, GreaterOrEqual) {
+    auto rValue = popOperand();
+    auto lValue = popOperand();
+    pushOperand(greaterOrEqual(lValue, rValue));
+    DISPATCH();
+  }
+  CASE(Instruction, Add) {
+    auto rValue = popOperand();
+    auto lValue = popOperand();
+    pushOperand(add(lValue, rValue));
+    DISPATCH();
+  }
+  CASE(Instruction, Subtract) {
+    auto rValue = popOperand();
+    auto lValue = popOperand();
+    pushOperand(subtract(lValue, rValue));
+    DISPATCH();
+  }
+  CASE(Instruction, Multiply) {
+    auto rValue = popOperand();
+    auto lValue = popOperand();
+    pushOperand(multiply(lValue, rValue));
+    DISPATCH();
+  }
+  CASE(Instruction, Divide) {
+    auto rValue = popOperand();
+    auto lValue = popOperand();
+    pushOperand(divide(lValue, rValue));
+    DISPATCH();
+  }
+  CASE(Instruction, Modulo) {
+    auto rValue = popOperand();
+    auto lValue = popOperand();
+    pushOperand(modulo(lValue, rValue));
+    DISPATCH();
+  }
+  CASE(Instruction, Absolute) {
+    pushOperand(absolute(popOperand()));
+    DISPATCH();
+  }
+  CASE(Instruction, ReverseSign) {
+    pushOperand(reverseSign(popOperand()));
+    DISPATCH();
+  }
+  CASE(Instruction, GetElement) {
+    auto index = popOperand();
+    auto sub = popOperand();
+    pushOperand(getElement(sub, index));
+    DISPATCH();
+  }
+  CASE(Instruction, SetElement) {
+    auto index = popOperand();
+    auto sub = popOperand();
+    setElement(sub, index, peekOperand());
+    DISPATCH();
+  }
+  CASE(Instruction, GetGlobal) {
+    auto operand = fetchOperand(ip);
+    pushOperand(getGlobal(functionTable, toString(constantList[operand])));
+    DISPATCH();
+  }
+  CASE(Instruction, SetGlobal) {
+    auto operand = fetchOperand(ip);
+    global[resolveGlobal(toString(constantList[operand]))] = peekOperand();
+    DISPATCH();
+  }
+  CASE(Instruction, GetGlobalSlot) {
+    auto operand = fetchOperand(ip);
+    pushOperand(global[operand]);
+    DISPATCH();
+  }
+  CASE(Instruction, SetGlobalSlot) {
+    auto operand = fetchOperand(ip);
+    global[operand] = peekOperand();
+    DISPATCH();
+  }
+  CASE(Instruction, GetLocal) {
+    auto operand = fetchOperand(ip);
+    pushOperand(bp[operand]);
+    DISPATCH();
+  }
+  CASE(Instruction, SetLocal) {
+    auto operand = fetchOperand(ip);
+    bp[operand] = peekOperand();
+    DISPATCH();
+  }
+  CASE(Instruction, PushNull) {
+    pushOperand(nullptr);
+    DISPATCH();
+  }
+  CASE(Instruction, PushBoolean) {
+    auto operand = fetchOperand(ip);
+    pushOperand(operand != 0);
+    DISPATCH();
+  }
+  CASE(Instruction, PushNumber) {
+    auto operand = fetchOperand(ip);
+    pushOperand(constantList[operand]);
+    DISPATCH();
+  }
+  CASE(Instruction, PushString) {
+    auto operand = fetchOperand(ip);
+    pushOperand(constantList[operand]);
+    DISPATCH();
+  }
+  CASE(Instruction, PushFunction) {
+    auto operand = fetchOperand(ip);
+    pushOperand(constantList[operand]);
+    DISPATCH();
+  }
+  CASE(Instruction, PushArray) {
+    auto operand = fetchOperand(ip);
+    auto result = new Array();
+    auto size = operand;
+    for (auto i = size; i > 0; i--)
+      result->values.push_back(popOperand());
+    pushOperand(result);
+    newObject(result);
+    DISPATCH();
+  }
+  CASE(Instruction, PushMap) {
+    auto operand = fetchOperand(ip);
+    auto result = new Map();
+    result->shape = &emptyShape;
+    for (size_t i = 0; i < operand; i++) {
       auto value = popOperand();
-      if (isNumber(value))
-        pushOperand(toNumber(value) * -1);
-      else
-        pushOperand(0.0);
-      break;
-    }
-    case Instruction::GetElement: {
-      auto index = popOperand();
-      auto sub = popOperand();
-      if (isArray(sub) && isNumber(index))
-        pushOperand(getValueOfArray(sub, index));
-      else if (isMap(sub) && isString(index))
-        pushOperand(getValueOfMap(sub, index));
-      else
-        pushOperand(nullptr);
-      break;
-    }
-    case Instruction::SetElement: {
-      auto index = popOperand();
-      auto sub = popOperand();
-      if (isArray(sub) && isNumber(index))
-        setValueOfArray(sub, index, peekOperand());
-      else if (isMap(sub) && isString(index))
-        setValueOfMap(sub, index, peekOperand());
-      break;
+      auto key = popOperand();
+      setValueOfMap(result, key, value);
     }
-    case Instruction::GetGlobal: {
-      auto name = toString(code.operand);
-      if (functionTable.count(name))
-        pushOperand(functionTable[name]);
-      else if (builtinFunctionTable.count(name))
-        pushOperand(builtinFunctionTable[name]);
-      else if (global.count(name))
-        pushOperand(global[name]);
-      else
-        pushOperand(nullptr);
-      break;
+    pushOperand(result);
+    newObject(result);
+    DISPATCH();
+  }
+  CASE(Instruction, PopOperand) {
+    popOperand();
+    DISPATCH();
+  }
+  CASE(Instruction, SetLocalPop) {
+    auto operand = fetchOperand(ip);
+    bp[operand] = popOperand();
+    DISPATCH();
+  }
+  CASE(Instruction, IncLocal) {
+    auto operand = fetchOperand(ip);
+    auto constant = fetchOperand(ip);
+    bp[operand] = add(bp[operand], constantList[constant]);
+    DISPATCH();
+  }
+  CASE(Instruction, AddNumber) {
+    auto operand = fetchOperand(ip);
+    auto lValue = popOperand();
+    pushOperand(add(lValue, constantList[operand]));
+    DISPATCH();
+  }
+  CASE(Instruction, EqualJump) {
+    auto operand = fetchOperand(ip);
+    auto rValue = popOperand();
+    auto lValue = popOperand();
+    if (isTrue(equal(lValue, rValue)) == false)
+      ip = code + operand;
+    DISPATCH();
+  }
+  CASE(Instruction, NotEqualJump) {
+    auto operand = fetchOperand(ip);
+    auto rValue = popOperand();
+    auto lValue = popOperand();
+    if (isTrue(notEqual(lValue, rValue)) == false)
+      ip = code + operand;
+    DISPATCH();
+  }
+  CASE(Instruction, LessThanJump) {
+    auto operand = fetchOperand(ip);
+    auto rValue = popOperand();
+    auto lValue = popOperand();
+    if (isTrue(lessThan(lValue, rValue)) == false)
+      ip = code + operand;
+    DISPATCH();
+  }
+  CASE(Instruction, GreaterThanJump) {
+    auto operand = fetchOperand(ip);
+    auto rValue = popOperand();
+    auto lValue = popOperand();
+    if (isTrue(greaterThan(lValue, rValue)) == false)
+      ip = code + operand;
+    DISPATCH();
+  }
+  CASE(Instruction, LessOrEqualJump) {
+    auto operand = fetchOperand(ip);
+    auto rValue = popOperand();
+    auto lValue = popOperand();
+    if (isTrue(lessOrEqual(lValue, rValue)) == false)
+      ip = code + operand;
+    DISPATCH();
+  }
+  CASE(Instruction, GreaterOrEqualJump) {
+    auto operand = fetchOperand(ip);
+    auto rValue = popOperand();
+    auto lValue = popOperand();
+    if (isTrue(greaterOrEqual(lValue, rValue)) == false)
+      ip = code + operand;
+    DISPATCH();
+  }
+  CASE(Instruction, LessThanLocalConstantJump) {
+    auto operand = fetchOperand(ip);
+    auto lValue = bp[fetchOperand(ip)];
+    auto rValue = constantList[fetchOperand(ip)];
+    if (isTrue(lessThan(lValue, rValue)) == false)
+      DISPATCH();
+    ip = code + operand;
+    if (allocatedSize >= options.nurserySize)
+      collectGarbage(sp);
+    DISPATCH();
+  }
+  CASE(Instruction, LessThanLocalLocalJump) {
+    auto operand = fetchOperand(ip);
+    auto lValue = bp[fetchOperand(ip)];
+    auto rValue = bp[fetchOperand(ip)];
+    if (isTrue(lessThan(lValue, rValue)) == false)
+      DISPATCH();
+    ip = code + operand;
+    if (allocatedSize >= options.nurserySize)
+      collectGarbage(sp);
+    DISPATCH();
+  }
+  CASE(Instruction, GetField) {
+    auto key = constantList[fetchOperand(ip)];
+    auto& cache = inlineCaches[fetchOperand(ip)];
+    auto sub = popOperand();
+    if (isMap(sub) && cache.shape != nullptr && toMap(sub)->shape == cache.shape)
+      pushOperand(toMap(sub)->fields[cache.slot]);
+    else
+      pushOperand(getField(sub, key, cache));
+    DISPATCH();
+  }
+  CASE(Instruction, SetField) {
+    auto key = constantList[fetchOperand(ip)];
+    auto& cache = inlineCaches[fetchOperand(ip)];
+    auto sub = popOperand();
+    if (isMap(sub) && cache.shape != nullptr && toMap(sub)->shape == cache.shape) {
+      writeBarrier(sub, peekOperand());
+      toMap(sub)->fields[cache.slot] = peekOperand();
     }
-    case Instruction::SetGlobal: {
-      auto name = toString(code.operand);
-      global[name] = peekOperand();
-      break;
+    else
+      setField(sub, key, peekOperand(), cache);
+    DISPATCH();
+  }
+#ifndef USE_COMPUTED_GOTO
     }
-    case Instruction::GetLocal: {
-      auto index = toSize(code.operand);
-      pushOperand(callStack.back().variables[index]);
-      break;
+  }
+#endif
+}
+
+auto Isolate::executeRegister(ObjectCode objectCode)->void {
+  global.clear();
+  globalTable.clear();
+  initializeHeap(objectCode.constantList);
+  linkRegister(objectCode);
+  valueStack.resize(StackSize);
+  callStack.emplace_back();
+  auto& constantList = objectCode.constantList;
+  auto& functionTable = objectCode.functionTable;
+  auto code = objectCode.codeList.data();
+  auto ip = code;
+  auto stack = valueStack.data();
+  auto sp = stack;
+  auto bp = stack;
+#ifdef USE_COMPUTED_GOTO
+  static void* dispatchTable[] = {
+    &&LabelRegisterInstructionExit,
+    &&LabelRegisterInstructionCall, &&LabelRegisterInstructionAlloca, &&LabelRegisterInstructionReturn,
+    &&LabelRegisterInstructionJump, &&LabelRegisterInstructionConditionJump,
+    &&LabelRegisterInstructionPrint, &&LabelRegisterInstructionPrintLine,
+    &&LabelRegisterInstructionLogicalOr, &&LabelRegisterInstructionLogicalAnd,
+    &&LabelRegisterInstructionAdd, &&LabelRegisterInstructionSubtract,
+    &&LabelRegisterInstructionMultiply, &&LabelRegisterInstructionDivide, &&LabelRegisterInstructionModulo,
+    &&LabelRegisterInstructionEqual, &&LabelRegisterInstructionNotEqual,
+    &&LabelRegisterInstructionLessThan, &&LabelRegisterInstructionGreaterThan,
+    &&LabelRegisterInstructionLessOrEqual, &&LabelRegisterInstructionGreaterOrEqual,
+    &&LabelRegisterInstructionAbsolute, &&LabelRegisterInstructionReverseSign,
+    &&LabelRegisterInstructionGetElement, &&LabelRegisterInstructionSetElement,
+    &&LabelRegisterInstructionGetGlobal, &&LabelRegisterInstructionSetGlobal,
+    &&LabelRegisterInstructionGetGlobalSlot, &&LabelRegisterInstructionSetGlobalSlot,
+    &&LabelRegisterInstructionMove,
+    &&LabelRegisterInstructionLoadNull, &&LabelRegisterInstructionLoadBoolean,
+    &&LabelRegisterInstructionLoadConstant,
+    &&LabelRegisterInstructionNewArray, &&LabelRegisterInstructionNewMap,
+  };
+  DISPATCH();
+#else
+  while (true) {
+    switch (static_cast<RegisterInstruction>(*ip++)) {
+#endif
+  CASE(RegisterInstruction, Exit) {
+    callStack.pop_back();
+    printStatistics();
+    return;
+  }
+  CASE(RegisterInstruction, Call) {
+    auto target = fetchOperand(ip);
+    auto callee = bp[fetchOperand(ip)];
+    auto base = fetchOperand(ip);
+    auto count = fetchOperand(ip);
+    if (isSize(callee)) {
+      callStack.back().instructionPointer = ip - code;
+      callStack.back().stackPointer = sp - stack;
+      callStack.back().resultRegister = target;
+      bp += base;
+      sp = bp + count;
+      callStack.push_back({0, static_cast<size_t>(bp - stack)});
+      ip = code + toSize(callee);
+      DISPATCH();
     }
-    case Instruction::SetLocal: {
-      auto index = toSize(code.operand);
-      callStack.back().variables[index] = peekOperand();
-      break;
+    if (isBuiltinFunction(callee)) {
+      bp[target] = callBuiltin(callee, bp + base, count);
+      DISPATCH();
     }
-    case Instruction::PushNull: {
-      pushOperand(nullptr);
-      break;
+    bp[target] = nullptr;
+    DISPATCH();
+  }
+  CASE(RegisterInstruction, Alloca) {
+    auto operand = fetchOperand(ip);
+    if (bp + operand > stack + StackSize) {
+      cout << "스택이 넘쳤습니다.";
+      exit(1);
     }
-    case Instruction::PushBoolean: {
-      pushOperand(code.operand);
-      break;
+    while (sp < bp + operand)
+      *sp++ = nullptr;
+    sp = bp + operand;
+    DISPATCH();
+  }
+  CASE(RegisterInstruction, Return) {
+    auto result = bp[fetchOperand(ip)];
+    callStack.pop_back();
+    auto& stackFrame = callStack.back();
+    bp = stack + stackFrame.basePointer;
+    sp = stack + stackFrame.stackPointer;
+    ip = code + stackFrame.instructionPointer;
+    bp[stackFrame.resultRegister] = result;
+    if (allocatedSize >= options.nurserySize)
+      collectGarbage(sp);
+    DISPATCH();
+  }
+  CASE(RegisterInstruction, Jump) {
+    ip = code + fetchOperand(ip);
+    if (allocatedSize >= options.nurserySize)
+      collectGarbage(sp);
+    DISPATCH();
+  }
+  CASE(RegisterInstruction, ConditionJump) {
+    auto address = fetchOperand(ip);
+    if (isTrue(bp[fetchOperand(ip)]) == false)
+      ip = code + address;
+    DISPATCH();
+  }
+  CASE(RegisterInstruction, Print) {
+    auto base = fetchOperand(ip);
+    auto count = fetchOperand(ip);
+    for (size_t i = 0; i < count; i++)
+      cout << bp[base + i];
+    DISPATCH();
+  }
+  CASE(RegisterInstruction, PrintLine) {
+    cout << endl;
+    DISPATCH();
+  }
+  CASE(RegisterInstruction, LogicalOr) {
+    auto address = fetchOperand(ip);
+    if (isTrue(bp[fetchOperand(ip)]))
+      ip = code + address;
+    DISPATCH();
+  }
+  CASE(RegisterInstruction, LogicalAnd) {
+    auto address = fetchOperand(ip);
+    if (isFalse(bp[fetchOperand(ip)]))
+      ip = code + address;
+    DISPATCH();
+  }
+  CASE(RegisterInstruction, Add) {
+    auto target = fetchOperand(ip);
+    auto lValue = bp[fetchOperand(ip)];
+    auto rValue = bp[fetchOperand(ip)];
+    bp[target] = add(lValue, rValue);
+    DISPATCH();
+  }
+  CASE(RegisterInstruction, Subtract) {
+    auto target = fetchOperand(ip);
+    auto lValue = bp[fetchOperand(ip)];
+    auto rValue = bp[fetchOperand(ip)];
+    bp[target] = subtract(lValue, rValue);
+    DISPATCH();
+  }
+  CASE(RegisterInstruction, Multiply) {
+    auto target = fetchOperand(ip);
+    auto lValue = bp[fetchOperand(ip)];
+    auto rValue = bp[fetchOperand(ip)];
+    bp[target] = multiply(lValue, rValue);
+    DISPATCH();
+  }
+  CASE(RegisterInstruction, Divide) {
+    auto target = fetchOperand(ip);
+    auto lValue = bp[fetchOperand(ip)];
+    auto rValue = bp[fetchOperand(ip)];
+    bp[target] = divide(lValue, rValue);
+    DISPATCH();
+  }
+  CASE(RegisterInstruction, Modulo) {
+    auto target = fetchOperand(ip);
+    auto lValue = bp[fetchOperand(ip)];
+    auto rValue = bp[fetchOperand(ip)];
+    bp[target] = modulo(lValue, rValue);
+    DISPATCH();
+  }
+  CASE(RegisterInstruction, Equal) {
+    auto target = fetchOperand(ip);
+    auto lValue = bp[fetchOperand(ip)];
+    auto rValue = bp[fetchOperand(ip)];
+    bp[target] = equal(lValue, rValue);
+    DISPATCH();
+  }
+  CASE(RegisterInstruction, NotEqual) {
+    auto target = fetchOperand(ip);
+    auto lValue = bp[fetchOperand(ip)];
+    auto rValue = bp[fetchOperand(ip)];
+    bp[target] = notEqual(lValue, rValue);
+    DISPATCH();
+  }
+  CASE(RegisterInstruction, LessThan) {
+    auto target = fetchOperand(ip);
+    auto lValue = bp[fetchOperand(ip)];
+    auto rValue = bp[fetchOperand(ip)];
+    bp[target] = lessThan(lValue, rValue);
+    DISPATCH();
+  }
+  CASE(RegisterInstruction, GreaterThan) {
+    auto target = fetchOperand(ip);
+    auto lValue = bp[fetchOperand(ip)];
+    auto rValue = bp[fetchOperand(ip)];
+    bp[target] = greaterThan(lValue, rValue);
+    DISPATCH();
+  }
+  CASE(RegisterInstruction, LessOrEqual) {
+    auto target = fetchOperand(ip);
+    auto lValue = bp[fetchOperand(ip)];
+    auto rValue = bp[fetchOperand(ip)];
+    bp[target] = lessOrEqual(lValue, rValue);
+    DISPATCH();
+  }
+  CASE(RegisterInstruction, GreaterOrEqual) {
+    auto target = fetchOperand(ip);
+    auto lValue = bp[fetchOperand(ip)];
+    auto rValue = bp[fetchOperand(ip)];
+    bp[target] = greaterOrEqual(lValue, rValue);
+    DISPATCH();
+  }
+  CASE(RegisterInstruction, Absolute) {
+    auto target = fetchOperand(ip);
+    bp[target] = absolute(bp[fetchOperand(ip)]);
+    DISPATCH();
+  }
+  CASE(RegisterInstruction, ReverseSign) {
+    auto target = fetchOperand(ip);
+    bp[target] = reverseSign(bp[fetchOperand(ip)]);
+    DISPATCH();
+  }
+  CASE(RegisterInstruction, GetElement) {
+    auto target = fetchOperand(ip);
+    auto sub = bp[fetchOperand(ip)];
+    auto index = bp[fetchOperand(ip)];
+    bp[target] = getElement(sub, index);
+    DISPATCH();
+  }
+  CASE(RegisterInstruction, SetElement) {
+    auto sub = bp[fetchOperand(ip)];
+    auto index = bp[fetchOperand(ip)];
+    auto value = bp[fetchOperand(ip)];
+    setElement(sub, index, value);
+    DISPATCH();
+  }
+  CASE(RegisterInstruction, GetGlobal) {
+    auto target = fetchOperand(ip);
+    bp[target] = getGlobal(functionTable, toString(constantList[fetchOperand(ip)]));
+    DISPATCH();
+  }
+  CASE(RegisterInstruction, SetGlobal) {
+    auto slot = resolveGlobal(toString(constantList[fetchOperand(ip)]));
+    global[slot] = bp[fetchOperand(ip)];
+    DISPATCH();
+  }
+  CASE(RegisterInstruction, GetGlobalSlot) {
+    auto target = fetchOperand(ip);
+    bp[target] = global[fetchOperand(ip)];
+    DISPATCH();
+  }
+  CASE(RegisterInstruction, SetGlobalSlot) {
+    auto slot = fetchOperand(ip);
+    global[slot] = bp[fetchOperand(ip)];
+    DISPATCH();
+  }
+  CASE(RegisterInstruction, Move) {
+    auto target = fetchOperand(ip);
+    bp[target] = bp[fetchOperand(ip)];
+    DISPATCH();
+  }
+  CASE(RegisterInstruction, LoadNull) {
+    bp[fetchOperand(ip)] = nullptr;
+    DISPATCH();
+  }
+  CASE(RegisterInstruction, LoadBoolean) {
+    auto target = fetchOperand(ip);
+    bp[target] = fetchOperand(ip) != 0;
+    DISPATCH();
+  }
+  CASE(RegisterInstruction, LoadConstant) {
+    auto target = fetchOperand(ip);
+    bp[target] = constantList[fetchOperand(ip)];
+    DISPATCH();
+  }
+  CASE(RegisterInstruction, NewArray) {
+    auto target = fetchOperand(ip);
+    auto base = fetchOperand(ip);
+    auto count = fetchOperand(ip);
+    auto result = new Array();
+    result->values.assign(bp + base, bp + base + count);
+    bp[target] = result;
+    newObject(result);
+    DISPATCH();
+  }
+  CASE(RegisterInstruction, NewMap) {
+    auto target = fetchOperand(ip);
+    auto base = fetchOperand(ip);
+    auto count = fetchOperand(ip);
+    auto result = new Map();
+    result->shape = &emptyShape;
+    for (size_t i = 0; i < count; i++)
+      setValueOfMap(result, bp[base + i * 2], bp[base + i * 2 + 1]);
+    bp[target] = result;
+    newObject(result);
+    DISPATCH();
+  }
+#ifndef USE_COMPUTED_GOTO
     }
-    case Instruction::PushNumber: {
-      pushOperand(code.operand);
-      break;
+  }
+#endif
+}
+
+auto Isolate::link(ObjectCode& objectCode)->void {
+  map<string, size_t> functionConstantTable;
+  auto& codeList = objectCode.codeList;
+  inlineCaches.clear();
+  for (size_t i = 0; i < codeList.size(); i += 1 + getOperandSize(static_cast<Instruction>(codeList[i]))) {
+    auto instruction = static_cast<Instruction>(codeList[i]);
+    if (instruction == Instruction::GetField || instruction == Instruction::SetField) {
+      writeOperand(&codeList[i + 5], inlineCaches.size());
+      inlineCaches.emplace_back();
+      continue;
     }
-    case Instruction::PushString: {
-      pushOperand(code.operand);
-      break;
+    if (instruction != Instruction::GetGlobal && instruction != Instruction::SetGlobal)
+      continue;
+    auto& name = toString(objectCode.constantList[readOperand(&codeList[i + 1])]);
+    if (instruction == Instruction::GetGlobal && (objectCode.functionTable.count(name) || builtinFunctionTable.count(name))) {
+      codeList[i] = static_cast<uint8_t>(Instruction::PushFunction);
+      writeOperand(&codeList[i + 1], resolveFunction(objectCode, functionConstantTable, name));
     }
-    case Instruction::PushArray: {
-      auto result = new Array();
-      auto size = toSize(code.operand);
-      for (auto i = size; i > 0; i--)
-        result->values.push_back(popOperand());
-      pushOperand(result);
-      objects.push_back(result);
-      break;
+    else {
+      codeList[i] = static_cast<uint8_t>(instruction == Instruction::GetGlobal ? Instruction::GetGlobalSlot : Instruction::SetGlobalSlot);
+      writeOperand(&codeList[i + 1], resolveGlobal(name));
     }
-    case Instruction::PushMap: {
-      auto result = new Map();
-      for (size_t i = 0; i < toSize(code.operand); i++) {
-        auto value = popOperand();
-        auto key = toString(popOperand());
-        result->values[key] = value;
+  }
+}
+
+auto Isolate::linkRegister(ObjectCode& objectCode)->void {
+  map<string, size_t> functionConstantTable;
+  auto& codeList = objectCode.codeList;
+  for (size_t i = 0; i < codeList.size(); i += 1 + getOperandCount(static_cast<RegisterInstruction>(codeList[i])) * sizeof(uint32_t)) {
+    auto instruction = static_cast<RegisterInstruction>(codeList[i]);
+    if (instruction == RegisterInstruction::GetGlobal) {
+      auto& name = toString(objectCode.constantList[readOperand(&codeList[i + 5])]);
+      if (objectCode.functionTable.count(name) || builtinFunctionTable.count(name)) {
+        codeList[i] = static_cast<uint8_t>(RegisterInstruction::LoadConstant);
+        writeOperand(&codeList[i + 5], resolveFunction(objectCode, functionConstantTable, name));
+      }
+      else {
+        codeList[i] = static_cast<uint8_t>(RegisterInstruction::GetGlobalSlot);
+        writeOperand(&codeList[i + 5], resolveGlobal(name));
       }
-      pushOperand(result);
-      objects.push_back(result);
-      break;
-    }
-    case Instruction::PopOperand: {
-      popOperand();
-      break;
     }
+    else if (instruction == RegisterInstruction::SetGlobal) {
+      auto& name = toString(objectCode.constantList[readOperand(&codeList[i + 1])]);
+      codeList[i] = static_cast<uint8_t>(RegisterInstruction::SetGlobalSlot);
+      writeOperand(&codeList[i + 1], resolveGlobal(name));
     }
-    callStack.back().instructionPointer += 1;
   }
 }
 
-auto pushOperand(any value)->void {
-  callStack.back().operandStack.push_back(value);
+auto resolveFunction(ObjectCode& objectCode, map<string, size_t>& functionConstantTable, string& name)->size_t {
+  if (functionConstantTable.count(name))
+    return functionConstantTable[name];
+  auto& constantList = objectCode.constantList;
+  if (objectCode.functionTable.count(name))
+    constantList.push_back(objectCode.functionTable[name]);
+  else
+    constantList.push_back(&builtinFunctionTable.at(name));
+  functionConstantTable[name] = constantList.size() - 1;
+  return constantList.size() - 1;
+}
+
+auto Isolate::resolveGlobal(string& name)->size_t {
+  if (globalTable.count(name) == 0) {
+    globalTable[name] = global.size();
+    global.push_back(nullptr);
+  }
+  return globalTable[name];
+}
+
+auto fetchOperand(uint8_t*& ip)->size_t {
+  auto operand = readOperand(ip);
+  ip += sizeof(uint32_t);
+  return operand;
+}
+
+// 계산된 goto는 블록을 벗어날 때 소멸자를 부르지 않으므로 인자 벡터는 명령어의 블록이
+// 아니라 이 함수 안에서 만들고 없앤다.
+auto callBuiltin(Value callee, Value* arguments, size_t count)->Value {
+  return toBuiltinFunction(callee)(vector<Value>(arguments, arguments + count));
+}
+
+auto Isolate::add(Value lValue, Value rValue)->Value {
+  if (isNumber(lValue) && isNumber(rValue))
+    return toNumber(lValue) + toNumber(rValue);
+  if (isString(lValue) && isString(rValue))
+    return newString(toString(lValue) + toString(rValue));
+  return 0.0;
 }
 
-auto peekOperand()->any {
-  return callStack.back().operandStack.back();
+// 캐시가 빗나가면 키로 찾은 다음, 모양이 있는 맵이면 그 모양과 슬롯을 캐시에 남긴다.
+// 사전 모드 맵은 캐시하지 않는다.
+auto getField(Value sub, Value key, InlineCache& cache)->Value {
+  if (isMap(sub) == false)
+    return nullptr;
+  auto shape = toMap(sub)->shape;
+  if (shape == nullptr)
+    return getValueOfMap(sub, key);
+  auto name = findKeyOf(key);
+  auto slot = name != nullptr ? shape->slots.find(name) : nullptr;
+  if (slot == nullptr)
+    return nullptr;
+  cache = {shape, *slot};
+  return toMap(sub)->fields[*slot];
 }
 
-auto popOperand()->any {
-  auto value = callStack.back().operandStack.back();
-  callStack.back().operandStack.pop_back();
-  return value;
+auto setField(Value sub, Value key, Value value, InlineCache& cache)->void {
+  if (isMap(sub) == false)
+    return;
+  setValueOfMap(sub, key, value);
+  auto shape = toMap(sub)->shape;
+  if (shape != nullptr)
+    cache = {shape, *shape->slots.find(findKeyOf(key))};
 }
 
-auto collectGarbage()->void {
-  for (auto& stackFrame: callStack) {
-    for (auto& value: stackFrame.operandStack)
-      markObject(value);
-    for (auto& value: stackFrame.variables)
-      markObject(value);
-  }
-  for (auto& [key, value]: global)
-    markObject(value);
-  sweepObject();
+auto Isolate::getGlobal(map<string, size_t>& functionTable, string& name)->Value {
+  if (functionTable.count(name))
+    return functionTable[name];
+  if (builtinFunctionTable.count(name))
+    return &builtinFunctionTable.at(name);
+  if (globalTable.count(name))
+    return global[globalTable[name]];
+  return nullptr;
 }
 
-auto markObject(any value)->void {
+Isolate::Isolate(GarbageCollectorOptions gcOptions) {
+  options = gcOptions;
+}
+
+Isolate::~Isolate() {
+  releaseHeap();
+}
+
+auto Isolate::newString(string value)->String* {
+  auto result = new String();
+  result->value = value;
+  newObject(result);
+  return result;
+}
+
+auto Isolate::newObject(Value value)->void {
+  youngObjects.push_back(value);
+  allocatedSize += sizeOfObject(value);
+}
+
+auto sizeOfObject(Value value)->size_t {
+  if (isString(value))
+    return sizeof(String) + toString(value).capacity();
+  if (isArray(value))
+    return sizeof(Array) + toArray(value)->values.capacity() * sizeof(Value);
+  if (isMap(value) && toMap(value)->shape != nullptr)
+    return sizeof(Map) + toMap(value)->fields.capacity() * sizeof(Value);
+  if (isMap(value))
+    return sizeof(Map) + toMap(value)->values.getMemorySize();
+  return 0;
+}
+
+auto Isolate::initializeHeap(vector<Value>& constantList)->void {
+  releaseHeap();
+  currentRememberedSet = &rememberedSet;
+  allocatedSize = 0;
+  oldSize = 0;
+  majorThreshold = options.heapSize;
+  statistics = {};
+  markConstants(constantList);
+}
+
+// 상수는 수집하지 않도록 오래된 객체로 표시하고, 문자열 상수에는 맵의 키를 미리 붙여 둔다.
+auto Isolate::markConstants(vector<Value>& constantList)->void {
+  for (auto& value: constantList) {
+    if (isObject(value))
+      toObject(value)->isOld = true;
+    if (isString(value))
+      internKeyOf(value);
+  }
+}
+
+auto Isolate::releaseHeap()->void {
+  for (auto& value: youngObjects)
+    delete toObject(value);
+  for (auto& value: oldObjects)
+    delete toObject(value);
+  youngObjects.clear();
+  oldObjects.clear();
+  rememberedSet.clear();
+}
+
+auto Isolate::collectGarbage(Value* stackPointer)->void {
+  auto begin = steady_clock::now();
+  auto isMajor = oldSize >= majorThreshold;
+  for (auto value = valueStack.data(); value < stackPointer; value++)
+    markObject(*value, isMajor);
+  for (auto& value: global)
+    markObject(value, isMajor);
+  for (auto& value: rememberedSet) {
+    if (isMajor == false)
+      markChildren(value, false);
+    toObject(value)->isRemembered = false;
+  }
+  rememberedSet.clear();
+  if (isMajor)
+    sweepOld();
+  sweepYoung();
+  allocatedSize = 0;
+  if (isMajor) {
+    majorThreshold = max(options.heapSize, static_cast<size_t>(oldSize * options.growthFactor));
+    statistics.majorCount++;
+  }
+  else {
+    statistics.minorCount++;
+  }
+  auto pause = duration<double, std::milli>(steady_clock::now() - begin).count();
+  statistics.totalPause += pause;
+  statistics.maxPause = max(statistics.maxPause, pause);
+}
+
+auto markObject(Value value, bool isMajor)->void {
+  if (isObject(value) == false)
+    return;
+  auto object = toObject(value);
+  if (object->isMarked || (object->isOld && isMajor == false))
+    return;
+  object->isMarked = true;
+  markChildren(value, isMajor);
+}
+
+auto markChildren(Value value, bool isMajor)->void {
   if (isArray(value)) {
-    if (toArray(value)->isMarked)
-      return;
-    toArray(value)->isMarked = true;
-    for (auto& value: toArray(value)->values)
-      markObject(value);
+    for (auto& element: toArray(value)->values)
+      markObject(element, isMajor);
   }
   else if (isMap(value)) {
-    if (toMap(value)->isMarked)
-      return;
-    toMap(value)->isMarked = true;
-    for (auto& [key, value]: toMap(value)->values)
-      markObject(value);
+    forEachOfMap(value, [&](const string&, Value& element) {
+      markObject(element, isMajor);
+    });
   }
 }
 
-auto sweepObject()->void {
-  objects.remove_if([](Object* object) {
-    if (object->isMarked) {
-      object->isMarked = false;
-      return false;
+auto Isolate::sweepYoung()->void {
+  for (auto& value: youngObjects) {
+    auto object = toObject(value);
+    if (object->isMarked == false) {
+      delete object;
+      continue;
     }
-    delete object;
-    return true;
-  });
+    object->isMarked = false;
+    object->isOld = true;
+    oldObjects.push_back(value);
+    oldSize += sizeOfObject(value);
+  }
+  youngObjects.clear();
+}
+
+auto Isolate::sweepOld()->void {
+  oldSize = 0;
+  auto survivor = oldObjects.begin();
+  for (auto& value: oldObjects) {
+    auto object = toObject(value);
+    if (object->isMarked == false) {
+      delete object;
+      continue;
+    }
+    object->isMarked = false;
+    oldSize += sizeOfObject(value);
+    *survivor++ = value;
+  }
+  oldObjects.erase(survivor, oldObjects.end());
+}
+
+auto Isolate::printStatistics()->void {
+  if (options.printStatistics == false)
+    return;
+  std::cerr << "가비지 컬렉션: 마이너 " << statistics.minorCount << "회, 메이저 " << statistics.majorCount << "회, ";
+  std::cerr << "총 정지 " << statistics.totalPause << "ms, 최대 정지 " << statistics.maxPause << "ms" << endl;
 }
@@ -1,4 +1,44 @@
-﻿#include "Main.h"
+﻿#include <chrono>
+#include "Main.h"
+
+using std::cout;
+using std::endl;
+using std::to_string;
+using std::chrono::duration;
+using std::chrono::steady_clock;
+
+static auto benchmarkScan(size_t megabytes)->void {
+  string sourceCode;
+  for (size_t i = 0; sourceCode.size() < megabytes * 1024 * 1024; i++) {
+    auto name = "element" + to_string(i);
+    sourceCode += R""""(
+    function count)"""" + name + R""""((list, limit) {
+      var total = 0;
+      for i = 0, i < limit, i = i + 1 {
+        if list[i] >= 12.5 and list[i] != null {
+          total = total + list[i] * 3 % 7;
+        }
+        elif list[i] == 'Hello, World!' {
+          printLine 'the quick brown fox jumps over the lazy dog';
+        }
+      }
+      return { 'name': ')"""" + name + R""""(', 'total': total };
+    }
+)"""";
+  }
+  size_t tokens = 0;
+  duration<double> fastest(0);
+  for (auto i = 0; i < 10; i++) {
+    auto begin = steady_clock::now();
+    tokens = scan(sourceCode).size();
+    duration<double> seconds = steady_clock::now() - begin;
+    if (i == 0 || seconds < fastest)
+      fastest = seconds;
+  }
+  auto size = sourceCode.size() / (1024.0 * 1024.0);
+  cout << size << " MB, " << tokens << " tokens: ";
+  cout << size / fastest.count() << " MB/s" << endl;
+}
 
 auto main(int argc, char** argv)->int {  
   string sourceCode = R""""(
@@ -6,9 +46,48 @@ auto main(int argc, char** argv)->int {
       print 'Hello, World!';
     }
   )"""";
-  auto tokenList = scan(sourceCode);
-  auto syntaxTree = parse(tokenList);
-  auto objectCode = generate(syntaxTree);
-  execute(objectCode);
+  GarbageCollectorOptions options;
+  auto isRegister = false;
+  auto isTiered = false;
+  auto isStreaming = false;
+  vector<string> paths;
+  for (auto i = 1; i < argc; i++) {
+    string argument = argv[i];
+    if (argument.rfind("--scan-benchmark=", 0) == 0) {
+      benchmarkScan(stoul(argument.substr(17)));
+      return 0;
+    }
+    else if (argument == "--register")
+      isRegister = true;
+    else if (argument == "--tiered")
+      isTiered = true;
+    else if (argument == "--stream")
+      isStreaming = true;
+    else if (argument == "--gc-stats")
+      options.printStatistics = true;
+    else if (argument.rfind("--gc-nursery=", 0) == 0)
+      options.nurserySize = stoul(argument.substr(13));
+    else if (argument.rfind("--gc-heap=", 0) == 0)
+      options.heapSize = stoul(argument.substr(10));
+    else
+      paths.push_back(argument);
+  }
+  unique_ptr<Program> syntaxTree;
+  if (paths.empty())
+    syntaxTree = parse(scan(sourceCode));
+  else
+    syntaxTree = parseFiles(paths, isStreaming);
+  optimize(syntaxTree.get());
+  Isolate isolate(options);
+  if (isRegister) {
+    isolate.executeRegister(generateRegister(syntaxTree.get()));
+    return 0;
+  }
+  if (isTiered) {
+    executeTiered(syntaxTree.get(), isolate);
+    return 0;
+  }
+  auto objectCode = generate(syntaxTree.get());
+  isolate.execute(objectCode);
   return 0;
 }
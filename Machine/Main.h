@@ -1,12 +1,19 @@
 #pragma once
-#include <tuple>
+#include <functional>
 #include "Token.h"
 #include "Node.h"
 #include "Code.h"
+#include "Isolate.h"
 
-using std::tuple;
+using std::istream;
+using std::function;
 
-auto scan(string)->vector<Token>;
-auto parse(vector<Token>)->Program*;
-auto generate(Program*)->tuple<vector<Code>, map<string, size_t>>;
-auto execute(tuple<vector<Code>, map<string, size_t>>)->void;
+auto scan(string_view)->vector<Token>;
+auto scanStream(istream&)->function<Token()>;
+auto parse(vector<Token>)->unique_ptr<Program>;
+auto parse(function<Token()>)->unique_ptr<Program>;
+auto parseFiles(vector<string>, bool)->unique_ptr<Program>;
+auto optimize(Program*)->void;
+auto generate(Program*)->ObjectCode;
+auto generateRegister(Program*)->ObjectCode;
+auto executeTiered(Program*, Isolate&)->void;
@@ -4,40 +4,77 @@
 #include <vector>
 #include <string>
 #include "Token.h"
+#include "Arena.h"
+#include "Datatype.h"
 
 using std::any;
 using std::map;
 using std::vector;
 using std::string;
 
+struct CodeGenContext;
+struct InterpreterContext;
+
+// 단계 0 인터프리터에서 문장을 실행한 뒤 흐름이 어떻게 이어지는지를 알린다.
+enum class Status {
+  Normal, Return, Break, Continue,
+};
+
 struct Program {
   vector<struct Function*> functions;
+  vector<unique_ptr<Program>> modules;
+  Arena arena;
 };
 
 struct Statement {
-  virtual auto generate()->void = 0;
+  virtual auto optimize(Arena&)->void = 0;
+  virtual auto generate(CodeGenContext&)->void = 0;
+  virtual auto generateRegister(CodeGenContext&)->void = 0;
+  virtual auto resolve(InterpreterContext&)->void = 0;
+  virtual auto interpret(InterpreterContext&)->Status = 0;
 };
 
 struct Expression {
-  virtual auto generate()->void = 0;
+  virtual auto optimize(Arena&)->Expression* = 0;
+  virtual auto generate(CodeGenContext&)->void = 0;
+  virtual auto generateRegister(CodeGenContext&, size_t)->void = 0;
+  virtual auto resolve(InterpreterContext&)->void = 0;
+  virtual auto interpret(InterpreterContext&)->void = 0;
 };
 
 struct Function: Statement {
   string name;
   vector<string> parameters;
   vector<Statement*> block;
-  auto generate()->void;
+  size_t localSize = 0;
+  size_t callCount = 0;
+  size_t loopCount = 0;
+  size_t address = SIZE_MAX;
+  auto optimize(Arena&)->void;
+  auto generate(CodeGenContext&)->void;
+  auto generateRegister(CodeGenContext&)->void;
+  auto resolve(InterpreterContext&)->void;
+  auto interpret(InterpreterContext&)->Status;
 };
 
 struct Variable: Statement {
   string name;
   Expression* expression;
-  auto generate()->void;
+  size_t slot = 0;
+  auto optimize(Arena&)->void;
+  auto generate(CodeGenContext&)->void;
+  auto generateRegister(CodeGenContext&)->void;
+  auto resolve(InterpreterContext&)->void;
+  auto interpret(InterpreterContext&)->Status;
 };
 
 struct Return: Statement {
   Expression* expression;
-  auto generate()->void;
+  auto optimize(Arena&)->void;
+  auto generate(CodeGenContext&)->void;
+  auto generateRegister(CodeGenContext&)->void;
+  auto resolve(InterpreterContext&)->void;
+  auto interpret(InterpreterContext&)->Status;
 };
 
 struct For: Statement {
@@ -45,122 +82,221 @@ struct For: Statement {
   Expression* condition;
   Expression* expression;
   vector<Statement*> block;
-  auto generate()->void;
+  size_t address = SIZE_MAX;
+  auto optimize(Arena&)->void;
+  auto generate(CodeGenContext&)->void;
+  auto generateRegister(CodeGenContext&)->void;
+  auto resolve(InterpreterContext&)->void;
+  auto interpret(InterpreterContext&)->Status;
 };
 
 struct Break: Statement {
-  auto generate()->void;
+  bool isInLoop = false;
+  auto optimize(Arena&)->void;
+  auto generate(CodeGenContext&)->void;
+  auto generateRegister(CodeGenContext&)->void;
+  auto resolve(InterpreterContext&)->void;
+  auto interpret(InterpreterContext&)->Status;
 };
 
 struct Continue: Statement {
-  auto generate()->void;
+  bool isInLoop = false;
+  auto optimize(Arena&)->void;
+  auto generate(CodeGenContext&)->void;
+  auto generateRegister(CodeGenContext&)->void;
+  auto resolve(InterpreterContext&)->void;
+  auto interpret(InterpreterContext&)->Status;
 };
 
 struct If: Statement {
   vector<Expression*> conditions;
   vector<vector<Statement*>> blocks;
   vector<Statement*> elseBlock;
-  auto generate()->void;
+  auto optimize(Arena&)->void;
+  auto generate(CodeGenContext&)->void;
+  auto generateRegister(CodeGenContext&)->void;
+  auto resolve(InterpreterContext&)->void;
+  auto interpret(InterpreterContext&)->Status;
 };
 
 struct Print: Statement {
   bool lineFeed = false;
   vector<Expression*> arguments;
-  auto generate()->void;
+  auto optimize(Arena&)->void;
+  auto generate(CodeGenContext&)->void;
+  auto generateRegister(CodeGenContext&)->void;
+  auto resolve(InterpreterContext&)->void;
+  auto interpret(InterpreterContext&)->Status;
 };
 
 struct ExpressionStatement: Statement {
   Expression* expression;
-  auto generate()->void;
+  auto optimize(Arena&)->void;
+  auto generate(CodeGenContext&)->void;
+  auto generateRegister(CodeGenContext&)->void;
+  auto resolve(InterpreterContext&)->void;
+  auto interpret(InterpreterContext&)->Status;
 };
 
 struct Or: Expression {
   Expression* lhs;
   Expression* rhs;
-  auto generate()->void;
+  auto optimize(Arena&)->Expression*;
+  auto generate(CodeGenContext&)->void;
+  auto generateRegister(CodeGenContext&, size_t)->void;
+  auto resolve(InterpreterContext&)->void;
+  auto interpret(InterpreterContext&)->void;
 };
 
 struct And: Expression {
   Expression* lhs;
   Expression* rhs;
-  auto generate()->void;
+  auto optimize(Arena&)->Expression*;
+  auto generate(CodeGenContext&)->void;
+  auto generateRegister(CodeGenContext&, size_t)->void;
+  auto resolve(InterpreterContext&)->void;
+  auto interpret(InterpreterContext&)->void;
 };
 
 struct Relational: Expression {
   Kind kind;
   Expression* lhs;
   Expression* rhs;
-  auto generate()->void;
+  auto optimize(Arena&)->Expression*;
+  auto generate(CodeGenContext&)->void;
+  auto generateRegister(CodeGenContext&, size_t)->void;
+  auto resolve(InterpreterContext&)->void;
+  auto interpret(InterpreterContext&)->void;
 };
 
 struct Arithmetic: Expression {
   Kind kind;
   Expression* lhs;
   Expression* rhs;
-  auto generate()->void;
+  auto optimize(Arena&)->Expression*;
+  auto generate(CodeGenContext&)->void;
+  auto generateRegister(CodeGenContext&, size_t)->void;
+  auto resolve(InterpreterContext&)->void;
+  auto interpret(InterpreterContext&)->void;
 };
 
 struct Unary: Expression {
   Kind kind;
   Expression* sub;
-  auto generate()->void;
+  auto optimize(Arena&)->Expression*;
+  auto generate(CodeGenContext&)->void;
+  auto generateRegister(CodeGenContext&, size_t)->void;
+  auto resolve(InterpreterContext&)->void;
+  auto interpret(InterpreterContext&)->void;
 };
 
 struct Call: Expression {
   Expression* sub;
   vector<Expression*> arguments;
-  auto generate()->void;
+  auto optimize(Arena&)->Expression*;
+  auto generate(CodeGenContext&)->void;
+  auto generateRegister(CodeGenContext&, size_t)->void;
+  auto resolve(InterpreterContext&)->void;
+  auto interpret(InterpreterContext&)->void;
 };
 
 struct GetElement: Expression {
   Expression* sub;
   Expression* index;
-  auto generate()->void;
+  auto optimize(Arena&)->Expression*;
+  auto generate(CodeGenContext&)->void;
+  auto generateRegister(CodeGenContext&, size_t)->void;
+  auto resolve(InterpreterContext&)->void;
+  auto interpret(InterpreterContext&)->void;
 };
 
 struct SetElement: Expression {
   Expression* sub;
   Expression* index;
   Expression* value;
-  auto generate()->void;
+  auto optimize(Arena&)->Expression*;
+  auto generate(CodeGenContext&)->void;
+  auto generateRegister(CodeGenContext&, size_t)->void;
+  auto resolve(InterpreterContext&)->void;
+  auto interpret(InterpreterContext&)->void;
 };
 
 struct GetVariable: Expression {
   string name;
-  auto generate()->void;
+  size_t slot = SIZE_MAX;
+  size_t globalSlot = SIZE_MAX;
+  Function* function = nullptr;
+  Value builtin;
+  auto optimize(Arena&)->Expression*;
+  auto generate(CodeGenContext&)->void;
+  auto generateRegister(CodeGenContext&, size_t)->void;
+  auto resolve(InterpreterContext&)->void;
+  auto interpret(InterpreterContext&)->void;
 };
 
 struct SetVariable: Expression {
   string name;
   Expression* value;
-  auto generate()->void;
+  size_t slot = SIZE_MAX;
+  size_t globalSlot = SIZE_MAX;
+  auto optimize(Arena&)->Expression*;
+  auto generate(CodeGenContext&)->void;
+  auto generateRegister(CodeGenContext&, size_t)->void;
+  auto resolve(InterpreterContext&)->void;
+  auto interpret(InterpreterContext&)->void;
 };
 
 struct NullLiteral: Expression {
-  auto generate()->void;
+  auto optimize(Arena&)->Expression*;
+  auto generate(CodeGenContext&)->void;
+  auto generateRegister(CodeGenContext&, size_t)->void;
+  auto resolve(InterpreterContext&)->void;
+  auto interpret(InterpreterContext&)->void;
 };
 
 struct BooleanLiteral: Expression {
   bool value = false;
-  auto generate()->void;
+  auto optimize(Arena&)->Expression*;
+  auto generate(CodeGenContext&)->void;
+  auto generateRegister(CodeGenContext&, size_t)->void;
+  auto resolve(InterpreterContext&)->void;
+  auto interpret(InterpreterContext&)->void;
 };
 
 struct NumberLiteral: Expression {
   double value = 0.0;
-  auto generate()->void;
+  auto optimize(Arena&)->Expression*;
+  auto generate(CodeGenContext&)->void;
+  auto generateRegister(CodeGenContext&, size_t)->void;
+  auto resolve(InterpreterContext&)->void;
+  auto interpret(InterpreterContext&)->void;
 };
 
 struct StringLiteral: Expression {
   string value;
-  auto generate()->void;
+  Value constant;
+  auto optimize(Arena&)->Expression*;
+  auto generate(CodeGenContext&)->void;
+  auto generateRegister(CodeGenContext&, size_t)->void;
+  auto resolve(InterpreterContext&)->void;
+  auto interpret(InterpreterContext&)->void;
 };
 
 struct ArrayLiteral: Expression {
   vector<Expression*> values;
-  auto generate()->void;
+  auto optimize(Arena&)->Expression*;
+  auto generate(CodeGenContext&)->void;
+  auto generateRegister(CodeGenContext&, size_t)->void;
+  auto resolve(InterpreterContext&)->void;
+  auto interpret(InterpreterContext&)->void;
 };
 
 struct MapLiteral: Expression {
   map<string, Expression*> values;
-  auto generate()->void;
+  vector<Value> keys;
+  auto optimize(Arena&)->Expression*;
+  auto generate(CodeGenContext&)->void;
+  auto generateRegister(CodeGenContext&, size_t)->void;
+  auto resolve(InterpreterContext&)->void;
+  auto interpret(InterpreterContext&)->void;
 };
@@ -0,0 +1,34 @@
+﻿#pragma once
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <algorithm>
+#include <functional>
+
+using std::min;
+using std::max;
+using std::atomic;
+using std::thread;
+using std::vector;
+using std::function;
+
+// 0부터 count - 1까지의 작업을 하드웨어 스레드 수만큼의 작업자가 하나씩 가져가 처리한다.
+// 작업자가 하나뿐이면 호출한 스레드에서 차례로 처리한다.
+inline auto parallelFor(size_t count, function<void(size_t)> task)->void {
+  auto workerCount = min<size_t>(count, max(thread::hardware_concurrency(), 1u));
+  if (workerCount <= 1) {
+    for (size_t i = 0; i < count; i++)
+      task(i);
+    return;
+  }
+  atomic<size_t> next(0);
+  vector<thread> workers;
+  for (size_t i = 0; i < workerCount; i++) {
+    workers.emplace_back([&]() {
+      for (auto index = next++; index < count; index = next++)
+        task(index);
+    });
+  }
+  for (auto& worker: workers)
+    worker.join();
+}
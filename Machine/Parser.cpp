@@ -1,74 +1,87 @@
 ﻿#include <set>
-#include <iostream>
+#include <functional>
 #include "Token.h"
 #include "Node.h"
 
 using std::set;
-using std::cout;
-
-static auto parseFunction()->Function*;
-static auto parseBlock()->vector<Statement*>;
-static auto parseVariable()->Variable*;
-static auto parseFor()->For*;
-static auto parseIf()->If*;
-static auto parsePrint()->Print*;
-static auto parseReturn()->Return*;
-static auto parseBreak()->Break*;
-static auto parseContinue()->Continue*;
-static auto parseExpressionStatement()->ExpressionStatement*;
-static auto parseExpression()->Expression*;
-static auto parseAssignment()->Expression*;
-static auto parseOr()->Expression*;
-static auto parseAnd()->Expression*;
-static auto parseRelational()->Expression*;
-static auto parseArithmetic1()->Expression*;
-static auto parseArithmetic2()->Expression*;
-static auto parseUnary()->Expression*;
-static auto parseOperand()->Expression*;
-static auto parseNullLiteral()->Expression*;
-static auto parseBooleanLiteral()->Expression*;
-static auto parseNumberLiteral()->Expression*;
-static auto parseStringLiteral()->Expression*;
-static auto parseListLiteral()->Expression*;
-static auto parseMapLiteral()->Expression*;
-static auto parseIdentifier()->Expression*;
-static auto parseInnerExpression()->Expression*;
-static auto parsePostfix(Expression*)->Expression*;
-static auto parseCall(Expression*)->Expression*;
-static auto parseElement(Expression*)->Expression*;
-static auto skipCurrent()->void;
-static auto skipCurrent(Kind)->void;
-static auto skipCurrentIf(Kind)->bool;
-
-static vector<Token>::iterator current;
-
-auto parse(vector<Token> tokens)->Program* {
-  auto result = new Program();
-  current = tokens.begin();
-  while (current->kind != Kind::EndOfToken) {
-    switch (current->kind) {
+using std::function;
+using std::make_unique;
+
+// 파싱 상태는 parse()를 호출할 때마다 새로 만들므로 여러 스레드에서 동시에 파싱할 수 있다.
+struct ParserContext {
+  Token current;
+  function<Token()> nextToken;
+  Arena* arena = nullptr;
+
+  auto parseFunction()->Function*;
+  auto parseBlock()->vector<Statement*>;
+  auto parseVariable()->Variable*;
+  auto parseFor()->For*;
+  auto parseIf()->If*;
+  auto parsePrint()->Print*;
+  auto parseReturn()->Return*;
+  auto parseBreak()->Break*;
+  auto parseContinue()->Continue*;
+  auto parseExpressionStatement()->ExpressionStatement*;
+  auto parseExpression()->Expression*;
+  auto parseAssignment()->Expression*;
+  auto parseOr()->Expression*;
+  auto parseAnd()->Expression*;
+  auto parseRelational()->Expression*;
+  auto parseArithmetic1()->Expression*;
+  auto parseArithmetic2()->Expression*;
+  auto parseUnary()->Expression*;
+  auto parseOperand()->Expression*;
+  auto parseNullLiteral()->Expression*;
+  auto parseBooleanLiteral()->Expression*;
+  auto parseNumberLiteral()->Expression*;
+  auto parseStringLiteral()->Expression*;
+  auto parseListLiteral()->Expression*;
+  auto parseMapLiteral()->Expression*;
+  auto parseIdentifier()->Expression*;
+  auto parseInnerExpression()->Expression*;
+  auto parsePostfix(Expression*)->Expression*;
+  auto parseCall(Expression*)->Expression*;
+  auto parseElement(Expression*)->Expression*;
+  auto skipCurrent()->void;
+  auto skipCurrent(Kind)->void;
+  auto skipCurrentIf(Kind)->bool;
+};
+
+auto parse(function<Token()> next)->unique_ptr<Program> {
+  auto result = make_unique<Program>();
+  ParserContext context;
+  context.arena = &result->arena;
+  context.nextToken = next;
+  context.current = context.nextToken();
+  while (context.current.kind != Kind::EndOfToken) {
+    switch (context.current.kind) {
       case Kind::Function: {
-        result->functions.push_back(parseFunction());
+        result->functions.push_back(context.parseFunction());
         break;
       }
       default: {
-        cout << *current << " 잘못된 구문입니다.";
-        exit(1);
+        throw SourceError{toString(context.current) + " 잘못된 구문입니다."};
       }
     }
   }
   return result;
 }
 
-auto parseFunction()->Function* {
-  auto result = new Function();
+auto parse(vector<Token> tokens)->unique_ptr<Program> {
+  auto iterator = tokens.begin();
+  return parse([&]() { return *iterator++; });
+}
+
+auto ParserContext::parseFunction()->Function* {
+  auto result = arena->make<Function>();
   skipCurrent(Kind::Function);
-  result->name = current->string;
+  result->name = current.string;
   skipCurrent(Kind::Identifier);
   skipCurrent(Kind::LeftParen);
-  if (current->kind != Kind::RightParen) {
+  if (current.kind != Kind::RightParen) {
     do {
-      result->parameters.push_back(current->string);
+      result->parameters.push_back(string(current.string));
       skipCurrent(Kind::Identifier);
     } while (skipCurrentIf(Kind::Comma));
   }
@@ -79,10 +92,10 @@ auto parseFunction()->Function* {
   return result;
 }
 
-auto parseBlock()->vector<Statement*> {
+auto ParserContext::parseBlock()->vector<Statement*> {
   vector<Statement*> result;
-  while (current->kind != Kind::RightBrace) {
-    switch (current->kind) {
+  while (current.kind != Kind::RightBrace) {
+    switch (current.kind) {
     default:               result.push_back(parseExpressionStatement()); break;
     case Kind::Variable:   result.push_back(parseVariable());            break;
     case Kind::For:        result.push_back(parseFor());                 break;
@@ -93,51 +106,46 @@ auto parseBlock()->vector<Statement*> {
     case Kind::Break:      result.push_back(parseBreak());               break;
     case Kind::Continue:   result.push_back(parseContinue());            break;
     case Kind::EndOfToken:
-      cout << *current << " 잘못된 구문입니다.";
-      exit(1);
+      throw SourceError{toString(current) + " 잘못된 구문입니다."};
     }
   }
   return result;
 }
 
-auto parseVariable()->Variable* {
-  auto result = new Variable();
+auto ParserContext::parseVariable()->Variable* {
+  auto result = arena->make<Variable>();
   skipCurrent(Kind::Variable);
-  result->name = current->string;
+  result->name = current.string;
   skipCurrent(Kind::Identifier);
   skipCurrent(Kind::Assignment);
   result->expression = parseExpression();
   if (result->expression == nullptr) {
-    cout << "변수 선언에 초기화식이 없습니다.";
-    exit(1);
+    throw SourceError{"변수 선언에 초기화식이 없습니다."};
   }
   skipCurrent(Kind::Semicolon);
   return result;
 }
 
-auto parseFor()->For* {
-  auto result = new For();
+auto ParserContext::parseFor()->For* {
+  auto result = arena->make<For>();
   skipCurrent(Kind::For);
-  result->variable = new Variable();
-  result->variable->name = current->string;
+  result->variable = arena->make<Variable>();
+  result->variable->name = current.string;
   skipCurrent(Kind::Identifier);
   skipCurrent(Kind::Assignment);
   result->variable->expression = parseExpression();
   if (result->variable->expression  == nullptr) {
-    cout << "for문에 초기화식이 없습니다.";
-    exit(1);
+    throw SourceError{"for문에 초기화식이 없습니다."};
   }
   skipCurrent(Kind::Comma);
   result->condition = parseExpression();
   if (result->condition == nullptr) {
-    cout << "for문에 조건식이 없습니다.";
-    exit(1);
+    throw SourceError{"for문에 조건식이 없습니다."};
   }
   skipCurrent(Kind::Comma);
   result->expression = parseExpression();
   if (result->expression == nullptr) {
-    cout << "for문에 증감식이 없습니다.";
-    exit(1);
+    throw SourceError{"for문에 증감식이 없습니다."};
   }
   skipCurrent(Kind::LeftBrace);
   result->block = parseBlock();
@@ -145,14 +153,13 @@ auto parseFor()->For* {
   return result;
 }
 
-auto parseIf()->If* {
-  auto result = new If();
+auto ParserContext::parseIf()->If* {
+  auto result = arena->make<If>();
   skipCurrent(Kind::If);
   do {
     auto condition = parseExpression();
     if (condition == nullptr) {
-      cout << "if문에 조건식이 없습니다.";
-      exit(1);
+      throw SourceError{"if문에 조건식이 없습니다."};
     }
     result->conditions.push_back(condition);
     skipCurrent(Kind::LeftBrace);
@@ -167,11 +174,11 @@ auto parseIf()->If* {
   return result;
 }
 
-auto parsePrint()->Print* {
-  auto result = new Print();
-  result->lineFeed = current->kind == Kind::PrintLine;
+auto ParserContext::parsePrint()->Print* {
+  auto result = arena->make<Print>();
+  result->lineFeed = current.kind == Kind::PrintLine;
   skipCurrent();
-  if (current->kind != Kind::Semicolon) {
+  if (current.kind != Kind::Semicolon) {
     do result->arguments.push_back(parseExpression());
     while (skipCurrentIf(Kind::Comma));
   }
@@ -179,69 +186,67 @@ auto parsePrint()->Print* {
   return result;
 }
 
-auto parseReturn()->Return* {
-  auto result = new Return();
+auto ParserContext::parseReturn()->Return* {
+  auto result = arena->make<Return>();
   skipCurrent(Kind::Return);
   result->expression = parseExpression();
   if (result->expression == nullptr) {
-    cout << "return문에 식이 없습니다.";
-    exit(1);
+    throw SourceError{"return문에 식이 없습니다."};
   }
   skipCurrent(Kind::Semicolon);
   return result;
 }
 
-auto parseBreak()->Break* {
-  auto result = new Break();
+auto ParserContext::parseBreak()->Break* {
+  auto result = arena->make<Break>();
   skipCurrent(Kind::Break);
   skipCurrent(Kind::Semicolon);
   return result;
 }
 
-auto parseContinue()->Continue* {
-  auto result = new Continue();
+auto ParserContext::parseContinue()->Continue* {
+  auto result = arena->make<Continue>();
   skipCurrent(Kind::Continue);
   skipCurrent(Kind::Semicolon);
   return result;
 }
 
-auto parseExpressionStatement()->ExpressionStatement* {
-  auto result = new ExpressionStatement();
+auto ParserContext::parseExpressionStatement()->ExpressionStatement* {
+  auto result = arena->make<ExpressionStatement>();
   result->expression = parseExpression();
   skipCurrent(Kind::Semicolon);
   return result;
 }
 
-auto parseExpression()->Expression* {
+auto ParserContext::parseExpression()->Expression* {
   return parseAssignment();
 }
 
-auto parseAssignment()->Expression* {
+auto ParserContext::parseAssignment()->Expression* {
   auto result = parseOr();
-  if (current->kind != Kind::Assignment)
+  if (current.kind != Kind::Assignment)
     return result;
   skipCurrent(Kind::Assignment);
   if (auto getVariable = dynamic_cast<GetVariable*>(result)) {
-    auto result = new SetVariable();
+    auto result = arena->make<SetVariable>();
     result->name = getVariable->name;
     result->value = parseAssignment();
     return result;
   }
   if (auto getElement = dynamic_cast<GetElement*>(result)) {
-    auto result = new SetElement();
+    auto result = arena->make<SetElement>();
     result->sub = getElement->sub;
     result->index = getElement->index;
     result->value = parseAssignment();
     return result;
   }
-  cout << "잘못된 대입 연산 식입니다.";
-  exit(1);
+  throw SourceError{"잘못된 대입 연산 식입니다."};
 }
 
-auto parseOr()->Expression* {
+auto ParserContext::parseOr()->Expression* {
   auto result = parseAnd();
   while (skipCurrentIf(Kind::LogicalOr)) {
-    auto temp = new Or();
+    auto temp = arena->make<Or>();
     temp->lhs = result;
     temp->rhs = parseAnd();
     result = temp;
@@ -249,10 +254,10 @@ auto parseOr()->Expression* {
   return result;
 }
 
-auto parseAnd()->Expression* {
+auto ParserContext::parseAnd()->Expression* {
   auto result = parseRelational();
   while (skipCurrentIf(Kind::LogicalAnd)) {
-    auto temp = new And();
+    auto temp = arena->make<And>();
     temp->lhs = result;
     temp->rhs = parseRelational();
     result = temp;
@@ -260,7 +265,7 @@ auto parseAnd()->Expression* {
   return result;
 }
 
-auto parseRelational()->Expression* {
+auto ParserContext::parseRelational()->Expression* {
   set<Kind> operators = {
     Kind::Equal,
     Kind::NotEqual,
@@ -270,9 +275,9 @@ auto parseRelational()->Expression* {
     Kind::GreaterOrEqual,
   };
   auto result = parseArithmetic1();
-  while (operators.count(current->kind)) {
-    auto temp = new Relational();
-    temp->kind = current->kind;
+  while (operators.count(current.kind)) {
+    auto temp = arena->make<Relational>();
+    temp->kind = current.kind;
     skipCurrent();
     temp->lhs = result;
     temp->rhs = parseArithmetic1();
@@ -281,15 +286,15 @@ auto parseRelational()->Expression* {
   return result;
 }
 
-auto parseArithmetic1()->Expression* {
+auto ParserContext::parseArithmetic1()->Expression* {
   set<Kind> operators = {
     Kind::Add,
     Kind::Subtract
   };
   auto result = parseArithmetic2();
-  while (operators.count(current->kind)) {
-    auto temp = new Arithmetic();
-    temp->kind = current->kind;
+  while (operators.count(current.kind)) {
+    auto temp = arena->make<Arithmetic>();
+    temp->kind = current.kind;
     skipCurrent();
     temp->lhs = result;
     temp->rhs = parseArithmetic2();
@@ -298,16 +303,16 @@ auto parseArithmetic1()->Expression* {
   return result;
 }
 
-auto parseArithmetic2()->Expression* {
+auto ParserContext::parseArithmetic2()->Expression* {
   set<Kind> operators = {
     Kind::Multiply,
     Kind::Divide,
     Kind::Modulo,
   };
   auto result = parseUnary();
-  while (operators.count(current->kind)) {
-    auto temp = new Arithmetic();
-    temp->kind = current->kind;
+  while (operators.count(current.kind)) {
+    auto temp = arena->make<Arithmetic>();
+    temp->kind = current.kind;
     skipCurrent();
     temp->lhs = result;
     temp->rhs = parseUnary();
@@ -316,14 +321,14 @@ auto parseArithmetic2()->Expression* {
   return result;
 }
 
-auto parseUnary()->Expression* {
+auto ParserContext::parseUnary()->Expression* {
   set<Kind> operators = {
     Kind::Add,
     Kind::Subtract,
   };
-  while (operators.count(current->kind)) {
-    auto result = new Unary();
-    result->kind = current->kind;
+  while (operators.count(current.kind)) {
+    auto result = arena->make<Unary>();
+    result->kind = current.kind;
     skipCurrent();
     result->sub = parseUnary();
     return result;
@@ -331,9 +336,9 @@ auto parseUnary()->Expression* {
   return parseOperand();
 }
 
-auto parseOperand()->Expression* {
+auto ParserContext::parseOperand()->Expression* {
   Expression* result = nullptr;
-  switch (current->kind) {
+  switch (current.kind) {
   case Kind::NullLiteral:   result = parseNullLiteral();      break;
   case Kind::TrueLiteral:
   case Kind::FalseLiteral:  result = parseBooleanLiteral();   break;
@@ -343,42 +348,42 @@ auto parseOperand()->Expression* {
   case Kind::LeftBrace:     result = parseMapLiteral();       break;
   case Kind::Identifier:    result = parseIdentifier();       break;
   case Kind::LeftParen:     result = parseInnerExpression();  break;
-  default:                  cout << "잘못된 식입니다.";       exit(1);
+  default:                  throw SourceError{"잘못된 식입니다."};
   }
   return parsePostfix(result);
 }
 
-auto parseNullLiteral()->Expression* {
+auto ParserContext::parseNullLiteral()->Expression* {
   skipCurrent(Kind::NullLiteral);
-  auto result = new NullLiteral();
+  auto result = arena->make<NullLiteral>();
   return result;
 }
 
-auto parseBooleanLiteral()->Expression* {
-  auto result = new BooleanLiteral();
-  result->value = current->kind == Kind::TrueLiteral;
+auto ParserContext::parseBooleanLiteral()->Expression* {
+  auto result = arena->make<BooleanLiteral>();
+  result->value = current.kind == Kind::TrueLiteral;
   skipCurrent();
   return result;
 }
 
-auto parseNumberLiteral()->Expression* {
-  auto result = new NumberLiteral();
-  result->value = stod(current->string);
+auto ParserContext::parseNumberLiteral()->Expression* {
+  auto result = arena->make<NumberLiteral>();
+  result->value = stod(string(current.string));
   skipCurrent(Kind::NumberLiteral);
   return result;
 }
 
-auto parseStringLiteral()->Expression* {
-  auto result = new StringLiteral();
-  result->value = current->string;
+auto ParserContext::parseStringLiteral()->Expression* {
+  auto result = arena->make<StringLiteral>();
+  result->value = current.string;
   skipCurrent(Kind::StringLiteral);
   return result;
 }
 
-auto parseListLiteral()->Expression* {
-  auto result = new ArrayLiteral();
+auto ParserContext::parseListLiteral()->Expression* {
+  auto result = arena->make<ArrayLiteral>();
   skipCurrent(Kind::LeftBraket);
-  if (current->kind != Kind::RightBraket) {
+  if (current.kind != Kind::RightBraket) {
     do result->values.push_back(parseExpression());
     while (skipCurrentIf(Kind::Comma));
   }
@@ -386,12 +391,12 @@ auto parseListLiteral()->Expression* {
   return result;
 }
 
-auto parseMapLiteral()->Expression* {
-  auto result = new MapLiteral();
+auto ParserContext::parseMapLiteral()->Expression* {
+  auto result = arena->make<MapLiteral>();
   skipCurrent(Kind::LeftBrace);
-  if (current->kind != Kind::RightBrace) {
+  if (current.kind != Kind::RightBrace) {
     do {
-      auto name = current->string;
+      auto name = string(current.string);
       skipCurrent(Kind::StringLiteral);
       skipCurrent(Kind::Colon);
       auto value = parseExpression();
@@ -402,23 +407,23 @@ auto parseMapLiteral()->Expression* {
   return result;
 }
 
-auto parseIdentifier()->Expression* {
-  auto result = new GetVariable();
-  result->name = current->string;
+auto ParserContext::parseIdentifier()->Expression* {
+  auto result = arena->make<GetVariable>();
+  result->name = current.string;
   skipCurrent(Kind::Identifier);
   return result;
 }
 
-auto parseInnerExpression()->Expression* {
+auto ParserContext::parseInnerExpression()->Expression* {
   skipCurrent(Kind::LeftParen);
   auto result = parseExpression();
   skipCurrent(Kind::RightParen);
   return result;
 }
 
-auto parsePostfix(Expression* sub)->Expression* {
+auto ParserContext::parsePostfix(Expression* sub)->Expression* {
   while (true) {
-    switch (current->kind) {
+    switch (current.kind) {
     case Kind::LeftParen:  sub = parseCall(sub);    break;
     case Kind::LeftBraket: sub = parseElement(sub); break;
     default: return sub;
@@ -426,11 +431,11 @@ auto parsePostfix(Expression* sub)->Expression* {
   }
 }
 
-auto parseCall(Expression* sub)->Expression* {
-  auto result = new Call();
+auto ParserContext::parseCall(Expression* sub)->Expression* {
+  auto result = arena->make<Call>();
   result->sub = sub;
   skipCurrent(Kind::LeftParen);
-  if (current->kind != Kind::RightParen) {
+  if (current.kind != Kind::RightParen) {
     do result->arguments.push_back(parseExpression());
     while (skipCurrentIf(Kind::Comma));
   }
@@ -438,8 +443,8 @@ auto parseCall(Expression* sub)->Expression* {
   return result;
 }
 
-auto parseElement(Expression* sub)->Expression* {
-  auto result = new GetElement();
+auto ParserContext::parseElement(Expression* sub)->Expression* {
+  auto result = arena->make<GetElement>();
   result->sub = sub;
   skipCurrent(Kind::LeftBraket);
   result->index = parseExpression();
@@ -447,21 +452,20 @@ auto parseElement(Expression* sub)->Expression* {
   return result;
 }
 
-auto skipCurrent()->void {
-  current++;
+auto ParserContext::skipCurrent()->void {
+  current = nextToken();
 }
 
-auto skipCurrent(Kind kind)->void {
-  if (current->kind != kind) {
-    cout << toString(kind) + " 토큰이 필요합니다.";
-    exit(1);
+auto ParserContext::skipCurrent(Kind kind)->void {
+  if (current.kind != kind) {
+    throw SourceError{toString(kind) + " 토큰이 필요합니다."};
   }
-  current++;
+  current = nextToken();
 }
 
-auto skipCurrentIf(Kind token_kind)->bool {
-  if (current->kind != token_kind)
+auto ParserContext::skipCurrentIf(Kind token_kind)->bool {
+  if (current.kind != token_kind)
     return false;
-  current++;
+  current = nextToken();
   return true;
 }
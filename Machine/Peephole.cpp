@@ -0,0 +1,212 @@
+﻿#include <vector>
+#include "Code.h"
+
+using std::vector;
+
+struct Operation {
+  Instruction instruction;
+  size_t operands[3] = {0, 0, 0};
+  bool isLabel = false;
+};
+
+static auto isJump(Instruction)->bool;
+static auto toFusedJump(Instruction)->Instruction;
+static auto isPush(Instruction)->bool;
+static auto decode(vector<uint8_t>&, vector<size_t>&)->vector<Operation>;
+static auto encode(vector<Operation>&, vector<size_t>&)->vector<uint8_t>;
+static auto threadJumps(vector<Operation>&)->void;
+static auto combine(vector<Operation>&, vector<size_t>&)->vector<Operation>;
+
+// 함수 하나의 스택 코드를 훑으며 자주 나오는 명령 묶음을 슈퍼 명령 하나로 합치고
+// 점프의 점프를 최종 목적지로 바로 잇는다. 점프 주소는 조각 안의 주소여야 한다.
+// labels의 주소는 점프 대상처럼 다루어 최적화한 코드의 주소로 고친다.
+auto optimizeCode(vector<uint8_t>& codeList, vector<size_t>& labels)->void {
+  auto operations = decode(codeList, labels);
+  threadJumps(operations);
+  operations = combine(operations, labels);
+  codeList = encode(operations, labels);
+}
+
+// 점프 주소는 첫 번째 피연산자이며 주소 대신 명령 번호로 바꿔 둔다. 코드 끝을 가리키면 명령 수가 된다.
+auto decode(vector<uint8_t>& codeList, vector<size_t>& labels)->vector<Operation> {
+  vector<Operation> result;
+  vector<size_t> indexOf(codeList.size() + 1, SIZE_MAX);
+  for (size_t i = 0; i < codeList.size();) {
+    Operation operation;
+    operation.instruction = static_cast<Instruction>(codeList[i]);
+    auto size = getOperandSize(operation.instruction);
+    for (size_t j = 0; j * sizeof(uint32_t) < size; j++)
+      operation.operands[j] = readOperand(&codeList[i + 1 + j * sizeof(uint32_t)]);
+    indexOf[i] = result.size();
+    result.push_back(operation);
+    i += 1 + size;
+  }
+  indexOf[codeList.size()] = result.size();
+  for (auto& operation: result) {
+    if (isJump(operation.instruction) == false)
+      continue;
+    operation.operands[0] = indexOf[operation.operands[0]];
+    if (operation.operands[0] < result.size())
+      result[operation.operands[0]].isLabel = true;
+  }
+  for (auto& label: labels) {
+    label = indexOf[label];
+    if (label < result.size())
+      result[label].isLabel = true;
+  }
+  return result;
+}
+
+auto encode(vector<Operation>& operations, vector<size_t>& labels)->vector<uint8_t> {
+  vector<size_t> addressOf(operations.size() + 1);
+  for (size_t i = 0; i < operations.size(); i++)
+    addressOf[i + 1] = addressOf[i] + 1 + getOperandSize(operations[i].instruction);
+  vector<uint8_t> result(addressOf.back());
+  for (size_t i = 0; i < operations.size(); i++) {
+    auto& operation = operations[i];
+    auto address = addressOf[i];
+    result[address] = static_cast<uint8_t>(operation.instruction);
+    if (isJump(operation.instruction))
+      operation.operands[0] = addressOf[operation.operands[0]];
+    for (size_t j = 0; j * sizeof(uint32_t) < getOperandSize(operation.instruction); j++)
+      writeOperand(&result[address + 1 + j * sizeof(uint32_t)], operation.operands[j]);
+  }
+  for (auto& label: labels)
+    label = addressOf[label];
+  return result;
+}
+
+// 무조건 점프로 가는 점프는 그 점프의 목적지로 바로 간다. 점프끼리 도는 경우를 막기 위해
+// 명령 수만큼만 따라간다.
+auto threadJumps(vector<Operation>& operations)->void {
+  for (auto& operation: operations) {
+    if (isJump(operation.instruction) == false)
+      continue;
+    auto target = operation.operands[0];
+    for (size_t count = 0; count < operations.size(); count++) {
+      if (target >= operations.size() || operations[target].instruction != Instruction::Jump)
+        break;
+      target = operations[target].operands[0];
+    }
+    operation.operands[0] = target;
+    if (target < operations.size())
+      operations[target].isLabel = true;
+  }
+}
+
+// 묶음의 두 번째 명령부터는 점프 대상이 아니어야 합칠 수 있다. 지운 명령을 가리키던
+// 점프는 그 다음에 남는 명령으로 간다.
+auto combine(vector<Operation>& operations, vector<size_t>& labels)->vector<Operation> {
+  vector<Operation> result;
+  vector<size_t> indexOf(operations.size() + 1);
+  auto matches = [&](size_t i, vector<Instruction> pattern) {
+    if (i + pattern.size() > operations.size())
+      return false;
+    for (size_t j = 0; j < pattern.size(); j++) {
+      if (operations[i + j].instruction != pattern[j])
+        return false;
+      if (j > 0 && operations[i + j].isLabel)
+        return false;
+    }
+    return true;
+  };
+  for (size_t i = 0; i < operations.size();) {
+    auto& operation = operations[i];
+    auto count = size_t(1);
+    auto isRemoved = false;
+    auto combined = operation;
+    if (matches(i, {Instruction::GetLocal, Instruction::PushNumber, Instruction::Add, Instruction::SetLocal, Instruction::PopOperand}) &&
+        operation.operands[0] == operations[i + 3].operands[0]) {
+      combined.instruction = Instruction::IncLocal;
+      combined.operands[1] = operations[i + 1].operands[0];
+      count = 5;
+    }
+    else if (matches(i, {Instruction::SetLocal, Instruction::PopOperand})) {
+      combined.instruction = Instruction::SetLocalPop;
+      count = 2;
+    }
+    else if (matches(i, {Instruction::PushNumber, Instruction::Add})) {
+      combined.instruction = Instruction::AddNumber;
+      count = 2;
+    }
+    else if (matches(i, {Instruction::PushString, Instruction::GetElement})) {
+      combined.instruction = Instruction::GetField;
+      count = 2;
+    }
+    else if (matches(i, {Instruction::PushString, Instruction::SetElement})) {
+      combined.instruction = Instruction::SetField;
+      count = 2;
+    }
+    else if (matches(i, {operation.instruction, Instruction::ConditionJump}) &&
+             toFusedJump(operation.instruction) != operation.instruction) {
+      combined.instruction = toFusedJump(operation.instruction);
+      combined.operands[0] = operations[i + 1].operands[0];
+      count = 2;
+    }
+    else if (isPush(operation.instruction) && matches(i, {operation.instruction, Instruction::PopOperand})) {
+      isRemoved = true;
+      count = 2;
+    }
+    else if (operation.instruction == Instruction::Jump && operation.operands[0] == i + 1) {
+      isRemoved = true;
+    }
+    for (auto j = i; j < i + count; j++)
+      indexOf[j] = result.size();
+    if (isRemoved == false)
+      result.push_back(combined);
+    i += count;
+  }
+  indexOf[operations.size()] = result.size();
+  for (auto& operation: result) {
+    if (isJump(operation.instruction))
+      operation.operands[0] = indexOf[operation.operands[0]];
+  }
+  for (auto& label: labels)
+    label = indexOf[label];
+  return result;
+}
+
+auto isJump(Instruction instruction)->bool {
+  switch (instruction) {
+  case Instruction::Jump:
+  case Instruction::ConditionJump:
+  case Instruction::LogicalOr:
+  case Instruction::LogicalAnd:
+  case Instruction::EqualJump:
+  case Instruction::NotEqualJump:
+  case Instruction::LessThanJump:
+  case Instruction::GreaterThanJump:
+  case Instruction::LessOrEqualJump:
+  case Instruction::GreaterOrEqualJump:
+  case Instruction::LessThanLocalConstantJump:
+  case Instruction::LessThanLocalLocalJump:
+    return true;
+  default:
+    return false;
+  }
+}
+
+auto toFusedJump(Instruction instruction)->Instruction {
+  switch (instruction) {
+  case Instruction::Equal:          return Instruction::EqualJump;
+  case Instruction::NotEqual:       return Instruction::NotEqualJump;
+  case Instruction::LessThan:       return Instruction::LessThanJump;
+  case Instruction::GreaterThan:    return Instruction::GreaterThanJump;
+  case Instruction::LessOrEqual:    return Instruction::LessOrEqualJump;
+  case Instruction::GreaterOrEqual: return Instruction::GreaterOrEqualJump;
+  default: return instruction;
+  }
+}
+
+auto isPush(Instruction instruction)->bool {
+  switch (instruction) {
+  case Instruction::GetLocal:
+  case Instruction::PushNull:
+  case Instruction::PushBoolean:
+  case Instruction::PushNumber:
+  case Instruction::PushString:
+    return true;
+  default:
+    return false;
+  }
+}
@@ -1,11 +1,23 @@
-﻿#include <vector>
+﻿#include <array>
+#include <deque>
+#include <vector>
 #include <string>
-#include <iostream>
+#include <memory>
+#include <algorithm>
+#include <functional>
+#include <string_view>
+#include <unordered_set>
 #include "Token.h"
 
-using std::cout;
+using std::array;
+using std::deque;
 using std::string;
 using std::vector;
+using std::istream;
+using std::function;
+using std::make_shared;
+using std::string_view;
+using std::unordered_set;
 
 enum class CharType {
   Unknown,
@@ -16,144 +28,259 @@ enum class CharType {
   OperatorAndPunctuator,
 };
 
-static auto scanNumberLiteral()->Token;
-static auto scanStringLiteral()->Token;
-static auto scanIdentifierAndKeyword()->Token;
-static auto scanOperatorAndPunctuator()->Token;
 static auto getCharType(char)->CharType;
 static auto isCharType(char, CharType)->bool;
 
-static string::iterator current;
-
-auto scan(string sourceCode)->vector<Token> {
-  vector<Token> result;
-  sourceCode += '\0';
-  current = sourceCode.begin();
-  while (*current != '\0') {
-    switch (getCharType(*current)) {
-      case CharType::WhiteSpace: {
-        current += 1;
-        break;
-      }
-      case CharType::NumberLiteral: {
-        result.push_back(scanNumberLiteral());
-        break;
-      }
-      case CharType::StringLiteral: {
-        result.push_back(scanStringLiteral());
-        break;
-      }
-      case CharType::IdentifierAndKeyword: {
-        result.push_back(scanIdentifierAndKeyword());
-        break;
-      }
-      case CharType::OperatorAndPunctuator: {
-        result.push_back(scanOperatorAndPunctuator());
-        break;
-      }
-      default: {
-        cout << *current << " 사용할 수 없는 문자입니다.";
-        exit(1);
-      }
-    }
+static constexpr auto charTypeTable = [] {
+  array<CharType, 256> result{};
+  for (auto c = 0; c < 256; c++) {
+    if (c == ' ' || c == '\t' || c == '\r' || c == '\n')
+      result[c] = CharType::WhiteSpace;
+    else if ('0' <= c && c <= '9')
+      result[c] = CharType::NumberLiteral;
+    else if (c == '\'')
+      result[c] = CharType::StringLiteral;
+    else if ('a' <= c && c <= 'z' || 'A' <= c && c <= 'Z')
+      result[c] = CharType::IdentifierAndKeyword;
+    else if (33 <= c && c <= 126)
+      result[c] = CharType::OperatorAndPunctuator;
   }
-  result.push_back({Kind::EndOfToken});
   return result;
-}
+}();
 
-auto scanNumberLiteral()->Token {
-  string string;
-  while (isCharType(*current, CharType::NumberLiteral))
-    string += *current++;
-  if (*current == '.') {
-    string += *current++;
-    while (isCharType(*current, CharType::NumberLiteral))
-      string += *current++;
+// 각 문자가 이어질 수 있는 토큰의 종류를 CharType 번호의 비트로 기록한다.
+static constexpr auto charClassTable = [] {
+  array<unsigned char, 256> result{};
+  for (auto c = 0; c < 256; c++) {
+    auto bits = 0;
+    if ('0' <= c && c <= '9')
+      bits |= 1 << static_cast<int>(CharType::NumberLiteral);
+    if (32 <= c && c <= 126 && c != '\'')
+      bits |= 1 << static_cast<int>(CharType::StringLiteral);
+    if ('0' <= c && c <= '9' || 'a' <= c && c <= 'z' || 'A' <= c && c <= 'Z')
+      bits |= 1 << static_cast<int>(CharType::IdentifierAndKeyword);
+    if (charTypeTable[c] == CharType::OperatorAndPunctuator || c == '\'')
+      bits |= 1 << static_cast<int>(CharType::OperatorAndPunctuator);
+    result[c] = static_cast<unsigned char>(bits);
   }
-  return Token{Kind::NumberLiteral, string};
-}
+  return result;
+}();
 
-auto scanStringLiteral()->Token {
-  string string;
-  current++;
-  while (isCharType(*current, CharType::StringLiteral))
-    string += *current++;
-  if (*current != '\'') {
-    cout << "문자열의 종료 문자가 없습니다.";
-    exit(1);
-  }
-  current++;
-  return Token{Kind::StringLiteral, string};
+static const size_t ChunkSize = 64 * 1024;
+
+// 스캔 상태는 스캔할 때마다 새로 만들므로 여러 스레드에서 동시에 스캔할 수 있다.
+struct Lexer {
+  const char* source = nullptr;
+  const char* current = nullptr;
+  const char* end = nullptr;
+  const char* lineBegin = nullptr;
+  size_t line = 1;
+  size_t sourceOffset = 0;
+  istream* stream = nullptr;
+  vector<char> buffer;
+  vector<char> remainder;
+  unordered_set<string_view> identifierTable;
+  deque<string> identifierStorage;
+
+  Lexer(string_view);
+  auto refill()->bool;
+  auto scanToken()->Token;
+  auto skipWhiteSpace()->void;
+  auto scanNumberLiteral()->Token;
+  auto scanStringLiteral()->Token;
+  auto scanIdentifierAndKeyword()->Token;
+  auto scanOperatorAndPunctuator()->Token;
+  auto skipCharIf(char)->bool;
+  auto makeToken(Kind, const char*)->Token;
+  auto skipCharType(const char*, CharType)->const char*;
+};
+
+auto scan(string_view sourceCode)->vector<Token> {
+  vector<Token> result;
+  Lexer lexer(sourceCode);
+  do {
+    result.push_back(lexer.scanToken());
+  } while (result.back().kind != Kind::EndOfToken);
+  return result;
 }
 
-auto scanIdentifierAndKeyword()->Token {
-  string string;
-  while (isCharType(*current, CharType::IdentifierAndKeyword))
-    string += *current++;
-  auto kind = toKind(string);
-  if (kind == Kind::Unknown)
-    kind = Kind::Identifier;
-  return Token{kind, string};
+auto scanStream(istream& input)->function<Token()> {
+  auto lexer = make_shared<Lexer>(string_view());
+  lexer->stream = &input;
+  return [lexer]() { return lexer->scanToken(); };
 }
 
-auto scanOperatorAndPunctuator()->Token {
-  string string;
-  while (isCharType(*current, CharType::OperatorAndPunctuator))
-    string += *current++;
-  while (string.empty() == false && toKind(string) == Kind::Unknown) {
-    string.pop_back();
-    current--;
-  }
-  if (string.empty()) {
-    cout << *current << " 사용할 수 없는 문자입니다.";
-    exit(1);
-  }
-  return Token{toKind(string), string};
+Lexer::Lexer(string_view sourceCode) {
+  source = sourceCode.data();
+  current = source;
+  end = source + sourceCode.size();
+  lineBegin = source;
 }
 
-auto getCharType(char c)->CharType {
-  if (' ' == c || '\t' == c || '\r' == c || '\n' == c) {
-    return CharType::WhiteSpace;
-  }
-  if ('0' <= c && c <= '9') {
-    return CharType::NumberLiteral;
-  }
-  if (c == '\'') {
-    return CharType::StringLiteral;
-  }
-  if ('a' <= c && c <= 'z' || 'A' <= c && c <= 'Z' ) {
-    return CharType::IdentifierAndKeyword;
-  }
-  if (33 <= c && c <= 47 && c != '\'' ||
-      58 <= c && c <= 64 ||
-      91 <= c && c <= 96 ||
-      123 <= c && c <= 126) {
-    return CharType::OperatorAndPunctuator;
+auto Lexer::refill()->bool {
+  if (stream == nullptr)
+    return false;
+  buffer.swap(remainder);
+  remainder.clear();
+  while (true) {
+    auto size = buffer.size();
+    buffer.resize(size + ChunkSize);
+    stream->read(buffer.data() + size, ChunkSize);
+    buffer.resize(size + stream->gcount());
+    if (stream->gcount() == 0)
+      break;
+    auto lineEnd = find(buffer.rbegin(), buffer.rend(), '\n').base();
+    if (lineEnd != buffer.begin()) {
+      remainder.assign(lineEnd, buffer.end());
+      buffer.erase(lineEnd, buffer.end());
+      break;
+    }
   }
-  return CharType::Unknown;
+  if (buffer.empty())
+    return false;
+  sourceOffset += end - source;
+  source = buffer.data();
+  current = source;
+  end = source + buffer.size();
+  lineBegin = source;
+  return true;
 }
 
-auto isCharType(char c, CharType type)->bool {
-  switch (type) {
+auto Lexer::scanToken()->Token {
+  while (true) {
+    skipWhiteSpace();
+    if (current != end || refill() == false)
+      break;
+  }
+  if (current == end)
+    return makeToken(Kind::EndOfToken, current);
+  switch (getCharType(*current)) {
     case CharType::NumberLiteral: {
-      return '0' <= c && c <= '9';
+      return scanNumberLiteral();
     }
     case CharType::StringLiteral: {
-      return 32 <= c && c <= 126 && c != '\'';
+      return scanStringLiteral();
     }
     case CharType::IdentifierAndKeyword: {
-      return '0' <= c && c <= '9' ||
-             'a' <= c && c <= 'z' ||
-             'A' <= c && c <= 'Z';
+      return scanIdentifierAndKeyword();
     }
     case CharType::OperatorAndPunctuator: {
-      return 33 <= c && c <= 47 ||
-              58 <= c && c <= 64 ||
-              91 <= c && c <= 96 ||
-              123 <= c && c <= 126;
+      return scanOperatorAndPunctuator();
     }
     default: {
-      return false;
+      throw SourceError{string(1, *current) + " 사용할 수 없는 문자입니다."};
     }
   }
 }
+
+auto Lexer::skipWhiteSpace()->void {
+  while (current != end && getCharType(*current) == CharType::WhiteSpace) {
+    if (*current++ == '\n') {
+      lineBegin = current;
+      line++;
+    }
+  }
+}
+
+auto Lexer::scanNumberLiteral()->Token {
+  auto begin = current;
+  while (current != end && isCharType(*current, CharType::NumberLiteral))
+    current++;
+  if (current != end && *current == '.') {
+    current++;
+    while (current != end && isCharType(*current, CharType::NumberLiteral))
+      current++;
+  }
+  return makeToken(Kind::NumberLiteral, begin);
+}
+
+auto Lexer::scanStringLiteral()->Token {
+  auto begin = ++current;
+  current = skipCharType(current, CharType::StringLiteral);
+  if (current == end || *current != '\'') {
+    throw SourceError{"문자열의 종료 문자가 없습니다."};
+  }
+  auto result = makeToken(Kind::StringLiteral, begin);
+  current++;
+  return result;
+}
+
+auto Lexer::scanIdentifierAndKeyword()->Token {
+  auto begin = current;
+  current = skipCharType(current, CharType::IdentifierAndKeyword);
+  auto result = makeToken(toKeyword(string_view(begin, current - begin)), begin);
+  if (result.kind == Kind::Unknown) {
+    result.kind = Kind::Identifier;
+    auto iterator = identifierTable.find(result.string);
+    if (iterator == identifierTable.end()) {
+      if (stream != nullptr) {
+        identifierStorage.emplace_back(result.string);
+        result.string = identifierStorage.back();
+      }
+      iterator = identifierTable.insert(result.string).first;
+    }
+    result.string = *iterator;
+  }
+  return result;
+}
+
+auto Lexer::scanOperatorAndPunctuator()->Token {
+  auto begin = current;
+  auto kind = Kind::Unknown;
+  switch (*current++) {
+    case '=': kind = skipCharIf('=') ? Kind::Equal : Kind::Assignment; break;
+    case '!': kind = skipCharIf('=') ? Kind::NotEqual : Kind::Unknown; break;
+    case '<': kind = skipCharIf('=') ? Kind::LessOrEqual : Kind::LessThan; break;
+    case '>': kind = skipCharIf('=') ? Kind::GreaterOrEqual : Kind::GreaterThan; break;
+    case '+': kind = Kind::Add; break;
+    case '-': kind = Kind::Subtract; break;
+    case '*': kind = Kind::Multiply; break;
+    case '/': kind = Kind::Divide; break;
+    case '%': kind = Kind::Modulo; break;
+    case ',': kind = Kind::Comma; break;
+    case ':': kind = Kind::Colon; break;
+    case ';': kind = Kind::Semicolon; break;
+    case '(': kind = Kind::LeftParen; break;
+    case ')': kind = Kind::RightParen; break;
+    case '{': kind = Kind::LeftBrace; break;
+    case '}': kind = Kind::RightBrace; break;
+    case '[': kind = Kind::LeftBraket; break;
+    case ']': kind = Kind::RightBraket; break;
+  }
+  if (kind == Kind::Unknown) {
+    current = begin;
+    throw SourceError{string(1, *current) + " 사용할 수 없는 문자입니다."};
+  }
+  return makeToken(kind, begin);
+}
+
+auto Lexer::skipCharIf(char c)->bool {
+  if (current == end || *current != c)
+    return false;
+  current++;
+  return true;
+}
+
+auto Lexer::makeToken(Kind kind, const char* begin)->Token {
+  Token result;
+  result.kind = kind;
+  result.string = string_view(begin, current - begin);
+  result.offset = sourceOffset + (begin - source);
+  result.line = line;
+  result.column = begin - lineBegin + 1;
+  return result;
+}
+
+auto getCharType(char c)->CharType {
+  return charTypeTable[static_cast<unsigned char>(c)];
+}
+
+auto isCharType(char c, CharType type)->bool {
+  return charClassTable[static_cast<unsigned char>(c)] & 1 << static_cast<int>(type);
+}
+
+auto Lexer::skipCharType(const char* position, CharType type)->const char* {
+  while (position != end && isCharType(*position, type))
+    position++;
+  return position;
+}
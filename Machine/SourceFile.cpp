@@ -0,0 +1,78 @@
+﻿#include "Token.h"
+#include "SourceFile.h"
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#ifdef _WIN32
+SourceFile::SourceFile(string path) {
+  file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (file == INVALID_HANDLE_VALUE)
+    fail();
+  LARGE_INTEGER fileSize;
+  if (GetFileSizeEx(file, &fileSize) == false)
+    fail();
+  size = static_cast<size_t>(fileSize.QuadPart);
+  if (size == 0)
+    return;
+  mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  if (mapping == nullptr)
+    fail();
+  data = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+  if (data == nullptr)
+    fail();
+}
+
+auto SourceFile::release()->void {
+  if (data != nullptr)
+    UnmapViewOfFile(data);
+  if (mapping != nullptr)
+    CloseHandle(mapping);
+  if (file != nullptr && file != INVALID_HANDLE_VALUE)
+    CloseHandle(file);
+  data = nullptr;
+  mapping = nullptr;
+  file = nullptr;
+}
+#else
+SourceFile::SourceFile(string path) {
+  descriptor = open(path.c_str(), O_RDONLY);
+  if (descriptor < 0)
+    fail();
+  struct stat status;
+  if (fstat(descriptor, &status) < 0)
+    fail();
+  size = static_cast<size_t>(status.st_size);
+  if (size == 0)
+    return;
+  auto address = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+  if (address == MAP_FAILED)
+    fail();
+  madvise(address, size, MADV_SEQUENTIAL);
+  data = static_cast<const char*>(address);
+}
+
+auto SourceFile::release()->void {
+  if (data != nullptr)
+    munmap(const_cast<char*>(data), size);
+  if (descriptor >= 0)
+    close(descriptor);
+  data = nullptr;
+  descriptor = -1;
+}
+#endif
+
+SourceFile::~SourceFile() {
+  release();
+}
+
+// 생성자에서 던지면 소멸자가 불리지 않으므로 연 것을 먼저 닫는다.
+auto SourceFile::fail()->void {
+  release();
+  throw SourceError{"파일을 열 수 없습니다."};
+}
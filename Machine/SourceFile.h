@@ -0,0 +1,29 @@
+﻿#pragma once
+#include <string>
+#include <string_view>
+
+using std::string;
+using std::string_view;
+
+struct SourceFile {
+  const char* data = nullptr;
+  size_t size = 0;
+#ifdef _WIN32
+  void* file = nullptr;
+  void* mapping = nullptr;
+#else
+  int descriptor = -1;
+#endif
+
+  SourceFile(string path);
+  SourceFile(const SourceFile&) = delete;
+  auto operator=(const SourceFile&)->SourceFile& = delete;
+  ~SourceFile();
+
+  auto release()->void;
+  auto fail()->void;
+
+  auto view() const->string_view {
+    return string_view(data, size);
+  }
+};
@@ -0,0 +1,19 @@
+#!/bin/sh
+# 사용법: asan.sh
+# AddressSanitizer로 두 가지 분기 방식을 모두 빌드하고 이 폴더의 스크립트를 세 가지
+# 실행 방식으로 실행한다. 누수가 있으면 출력이 달라지거나 종료 코드가 0이 아니게 된다.
+folder=$(dirname "$0")
+output=${TMPDIR:-/tmp}/machine-asan
+mkdir -p "$output"
+# 문자열 상수는 프로그램이 끝날 때까지 쓰이므로 해제하지 않는다. 그 밖의 누수만 잡는다.
+echo "leak:CodeGenContext::toConstant" > "$output/suppressions.txt"
+LSAN_OPTIONS=suppressions=$output/suppressions.txt:print_suppressions=0
+export LSAN_OPTIONS
+status=0
+for define in "" -DDISABLE_COMPUTED_GOTO; do
+  g++ -std=c++17 -O1 -g -w -fsanitize=address $define "$folder"/../*.cpp -o "$output/machine" || exit 1
+  for mode in "" --tiered --register; do
+    "$folder/run.sh" "$output/machine" $mode || status=1
+  done
+done
+exit $status
@@ -0,0 +1,18 @@
+#!/bin/sh
+# 사용법: run.sh <실행 파일> [옵션...]
+# 이 폴더의 스크립트를 실행해 같은 이름의 .out 파일과 출력을 비교한다.
+# 실행 파일이 0이 아닌 코드로 끝나도 실패로 친다.
+binary=$1
+shift
+actual=${TMPDIR:-/tmp}/run-$$.out
+status=0
+for script in "$(dirname "$0")"/*.yu; do
+  if "$binary" "$@" "$script" > "$actual" && cmp -s "$actual" "${script%.yu}.out"; then
+    echo "ok   $script"
+  else
+    echo "FAIL $script"
+    status=1
+  fi
+done
+rm -f "$actual"
+exit $status
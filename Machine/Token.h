@@ -1,9 +1,11 @@
 ﻿#pragma once
 #include <string>
 #include <iostream>
+#include <string_view>
 
 using std::string;
 using std::ostream;
+using std::string_view;
 
 enum class Kind {
   Unknown, EndOfToken,
@@ -33,12 +35,23 @@ enum class Kind {
   LeftBraket, RightBraket,
 };
 
-auto toKind(string)->Kind;
+auto toKind(string_view)->Kind;
+auto toKeyword(string_view)->Kind;
 auto toString(Kind)->string;
 
 struct Token {
   Kind kind = Kind::Unknown;
-  string string;
+  string_view string;
+  size_t offset = 0;
+  size_t line = 0;
+  size_t column = 0;
 };
 
 auto operator<<(ostream&, Token&)->ostream&;
+auto toString(Token&)->string;
+
+// 소스 파일을 읽거나 스캔하거나 파싱하다 난 오류다. 여러 파일을 여러 스레드에서 처리하므로
+// 그 자리에서 끝내지 않고 파일을 처리한 쪽으로 알린다.
+struct SourceError {
+  string message;
+};